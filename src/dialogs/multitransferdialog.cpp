@@ -0,0 +1,380 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <ctime>
+
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QSettings>
+#include <QThread>
+#include <QVBoxLayout>
+
+#include "mvf/models.hpp"
+#include "mvf/views/profile_cache.hpp"
+#include "util/devicecapture.hpp"
+#include "util/mixtable.hpp"
+#include "workers/importworker.hpp"
+
+#include "multitransferdialog.hpp"
+
+MultiTransferDialog::MultiTransferDialog(const std::vector<DiveComputer::Ptr> & computers, QWidget * parent)
+	: QDialog(parent), m_rows(computers.size()), m_workers(), m_pool(), m_persistQueue(), m_persisting(-1),
+	  m_persistTimer(), m_running(0), m_saved(0), m_failed(0), m_savedDives(0), m_lblSummary(0),
+	  m_btnStart(0), m_btnClose(0)
+{
+	QGridLayout * grid = new QGridLayout;
+	grid->setColumnStretch(2, 1);
+
+	for (size_t i = 0; i < m_rows.size(); ++i)
+	{
+		transfer_row_t & row = m_rows[i];
+		row.dc = computers[i];
+		row.running = false;
+		row.failed = false;
+
+		QString name;
+		if (row.dc->name().is_initialized())
+			name = QString::fromStdString(row.dc->name().get());
+		else
+			name = tr("'%1' Device").arg(QString::fromStdString(row.dc->driver()));
+
+		row.chkName = new QCheckBox(name);
+		row.chkName->setChecked(true);
+		row.pbTransfer = new QProgressBar;
+		row.pbTransfer->setMinimumWidth(200);
+		row.lblStatus = new QLabel(tr("Serial number %1").arg(QString::fromStdString(row.dc->serial())));
+		row.lblStatus->setMinimumWidth(250);
+
+		grid->addWidget(row.chkName, i, 0);
+		grid->addWidget(row.pbTransfer, i, 1);
+		grid->addWidget(row.lblStatus, i, 2);
+	}
+
+	m_lblSummary = new QLabel(tr("Select the dive computers to transfer from"));
+
+	m_btnStart = new QPushButton(tr("Start"));
+	m_btnClose = new QPushButton(tr("Close"));
+	connect(m_btnStart, SIGNAL(clicked()), this, SLOT(btnStartClicked()));
+	connect(m_btnClose, SIGNAL(clicked()), this, SLOT(reject()));
+
+	QHBoxLayout * hbox = new QHBoxLayout;
+	hbox->addStretch(1);
+	hbox->addWidget(m_btnStart, 0);
+	hbox->addWidget(m_btnClose, 0);
+	hbox->addStretch(1);
+
+	QVBoxLayout * vbox = new QVBoxLayout;
+	vbox->addLayout(grid);
+	vbox->addWidget(m_lblSummary);
+	vbox->addLayout(hbox);
+
+	setLayout(vbox);
+	setWindowTitle(tr("Transfer from Multiple Computers"));
+}
+
+MultiTransferDialog::~MultiTransferDialog()
+{
+	// Workers are kept until here so that senderRow() can map their Signals
+	m_pool.waitForDone();
+	qDeleteAll(m_workers.keys());
+}
+
+void MultiTransferDialog::btnStartClicked()
+{
+	m_btnStart->setEnabled(false);
+
+	int count = 0;
+	for (size_t i = 0; i < m_rows.size(); ++i)
+		if (m_rows[i].chkName->isChecked())
+			++count;
+
+	// One Thread per Computer, so that a slow Device does not queue the others
+	m_pool.setMaxThreadCount(std::max(count, 1));
+
+	// Split the Parse Threads between the Transfers
+	int parseThreads = std::max(QThread::idealThreadCount() / std::max(count, 1), 1);
+
+	// Share one Mix Table so that a new Gas is only added to the Logbook once
+	MixTable::Ptr mixes;
+
+	QSettings s;
+	for (size_t i = 0; i < m_rows.size(); ++i)
+	{
+		transfer_row_t & row = m_rows[i];
+		row.chkName->setEnabled(false);
+		if (! row.chkName->isChecked())
+		{
+			row.lblStatus->setText(tr("Skipped"));
+			continue;
+		}
+
+		// Use the Options set for the Computer in the Computer View
+		s.beginGroup(QString("DiveComputer-%1").arg(row.dc->id()));
+		bool checkSN = (s.value("checksn", Qt::Checked).toInt() == Qt::Checked);
+		bool updateToken = (s.value("update", Qt::Checked).toInt() == Qt::Checked);
+		bool capture = (s.value("capture", Qt::Unchecked).toInt() == Qt::Checked);
+		s.endGroup();
+
+		if (! mixes)
+		{
+			mixes.reset(new MixTable);
+			mixes->load(row.dc->session());
+		}
+
+		TransferWorker * worker = new TransferWorker(row.dc, row.dc->session(), checkSN, updateToken);
+		worker->setAutoDelete(false);
+		worker->setParseThreads(parseThreads);
+		worker->prepare(mixes);
+		if (capture)
+			worker->setCaptureFile(DeviceCapture::capturePath(row.dc->driver(), row.dc->serial()));
+
+		connect(worker, SIGNAL(finished()), this, SLOT(xfrFinished()), Qt::QueuedConnection);
+		connect(worker, SIGNAL(parsedDives(const profile_list_t &)), this, SLOT(xfrDives(const profile_list_t &)), Qt::QueuedConnection);
+		connect(worker, SIGNAL(parsed(unsigned long)), this, SLOT(xfrParsed(unsigned long)), Qt::QueuedConnection);
+		connect(worker, SIGNAL(progress(unsigned long)), this, SLOT(xfrProgress(unsigned long)), Qt::QueuedConnection);
+		connect(worker, SIGNAL(started(unsigned long)), this, SLOT(xfrStarted(unsigned long)), Qt::QueuedConnection);
+		connect(worker, SIGNAL(stats(const transfer_stats_t &)), this, SLOT(xfrStats(const transfer_stats_t &)), Qt::QueuedConnection);
+		connect(worker, SIGNAL(status(const QString &)), this, SLOT(xfrStatus(const QString &)), Qt::QueuedConnection);
+		connect(worker, SIGNAL(transferError(const QString &)), this, SLOT(xfrError(const QString &)), Qt::QueuedConnection);
+
+		connect(this, SIGNAL(cancelled()), worker, SLOT(cancel()), Qt::QueuedConnection);
+
+		row.running = true;
+		++m_running;
+
+		m_workers.insert(worker, (int)i);
+		m_pool.start(worker);
+	}
+
+	updateSummary();
+}
+
+void MultiTransferDialog::importError(const QString & msg)
+{
+	if (m_persisting < 0)
+		return;
+
+	transfer_row_t & row = m_rows[m_persisting];
+	row.failed = true;
+	row.lblStatus->setText(tr("Failed to save the transferred dives: %1").arg(msg));
+	row.lblStatus->setStyleSheet("QLabel { color: red }");
+}
+
+void MultiTransferDialog::importFinished()
+{
+	CustomTableModel::endBulkUpdate();
+
+	if (m_persisting < 0)
+		return;
+
+	transfer_row_t & row = m_rows[m_persisting];
+	row.stats.persistMs = m_persistTimer.elapsed();
+	logTransferStats(row.dc, row.stats);
+
+	if (row.failed)
+	{
+		++m_failed;
+	}
+	else
+	{
+		row.lblStatus->setText(tr("Saved %1 dives").arg(row.dives.size()));
+		row.pbTransfer->setValue(row.pbTransfer->maximum());
+
+		++m_saved;
+		m_savedDives += row.dives.size();
+	}
+
+	profile_list_t::const_iterator it;
+	for (it = row.dives.begin(); it != row.dives.end(); it++)
+		ProfileCache::Instance()->invalidate(* it);
+
+	// Release the Profiles, the Logbook holds them now
+	profile_list_t().swap(row.dives);
+
+	m_persisting = -1;
+	persistNext();
+	updateSummary();
+}
+
+void MultiTransferDialog::importProgress(int count)
+{
+	if (m_persisting >= 0)
+		m_rows[m_persisting].pbTransfer->setValue(count);
+}
+
+void MultiTransferDialog::persistNext()
+{
+	if ((m_persisting >= 0) || m_persistQueue.empty())
+		return;
+
+	m_persisting = m_persistQueue.front();
+	m_persistQueue.pop_front();
+
+	transfer_row_t & row = m_rows[m_persisting];
+	row.lblStatus->setText(tr("Saving %1 dives to the logbook").arg(row.dives.size()));
+	row.pbTransfer->setRange(0, std::max<int>(row.dives.size(), 1));
+	row.pbTransfer->setValue(0);
+
+	ImportWorker * worker = new ImportWorker(row.dc->session(), row.dives, row.dc);
+
+	connect(worker, SIGNAL(progress(int)), this, SLOT(importProgress(int)), Qt::QueuedConnection);
+	connect(worker, SIGNAL(importError(const QString &)), this, SLOT(importError(const QString &)), Qt::QueuedConnection);
+	connect(worker, SIGNAL(finished()), this, SLOT(importFinished()), Qt::QueuedConnection);
+	connect(worker, SIGNAL(finished()), worker, SLOT(deleteLater()));
+
+	// Suspend per-row Model Updates until this Computer's Import is done
+	CustomTableModel::beginBulkUpdate();
+	m_persistTimer.start();
+	worker->start();
+}
+
+void MultiTransferDialog::reject()
+{
+	// Transfers can be cancelled, but Imports always run to completion
+	if (m_running)
+	{
+		emit cancelled();
+		m_lblSummary->setText(tr("Cancelling transfers..."));
+		return;
+	}
+
+	if ((m_persisting >= 0) || ! m_persistQueue.empty())
+		return;
+
+	done(m_saved ? QDialog::Accepted : QDialog::Rejected);
+}
+
+MultiTransferDialog::transfer_row_t * MultiTransferDialog::senderRow()
+{
+	QHash<QObject *, int>::const_iterator it = m_workers.constFind(sender());
+	if (it == m_workers.constEnd())
+		return 0;
+
+	return & m_rows[it.value()];
+}
+
+void MultiTransferDialog::updateSummary()
+{
+	int pending = m_persistQueue.size() + ((m_persisting >= 0) ? 1 : 0);
+
+	m_lblSummary->setText(tr("%1 transferring, %2 waiting to save, %3 saved (%4 dives), %5 failed")
+		.arg(m_running)
+		.arg(pending)
+		.arg(m_saved)
+		.arg(m_savedDives)
+		.arg(m_failed));
+
+	m_btnClose->setText((m_running || pending) ? tr("Cancel") : tr("Close"));
+}
+
+void MultiTransferDialog::xfrDives(const profile_list_t & profiles)
+{
+	transfer_row_t * row = senderRow();
+	if (row)
+		row->dives.insert(row->dives.end(), profiles.begin(), profiles.end());
+}
+
+void MultiTransferDialog::xfrError(const QString & msg)
+{
+	transfer_row_t * row = senderRow();
+	if (! row)
+		return;
+
+	row->lblStatus->setText(msg);
+	row->lblStatus->setStyleSheet("QLabel { color: red }");
+
+	if (row->running)
+	{
+		row->running = false;
+		row->failed = true;
+		--m_running;
+		++m_failed;
+	}
+
+	updateSummary();
+}
+
+void MultiTransferDialog::xfrFinished()
+{
+	transfer_row_t * row = senderRow();
+	if (! row || ! row->running)
+		return;
+
+	row->running = false;
+	--m_running;
+
+	// Queue the Dives for the serialized Import
+	if (! row->stats.token.empty())
+		row->dc->setToken(row->stats.token);
+	row->dc->setLastTransfer(time(NULL));
+	row->lblStatus->setText(tr("Waiting to save %1 dives").arg(row->dives.size()));
+	m_persistQueue.push_back(row - & m_rows[0]);
+
+	persistNext();
+	updateSummary();
+}
+
+void MultiTransferDialog::xfrParsed(unsigned long count)
+{
+	transfer_row_t * row = senderRow();
+	if (row && row->running)
+		row->lblStatus->setText(tr("Parsed %1 dives").arg(count));
+}
+
+void MultiTransferDialog::xfrProgress(unsigned long bytes)
+{
+	transfer_row_t * row = senderRow();
+	if (row && row->running)
+		row->pbTransfer->setValue(bytes);
+}
+
+void MultiTransferDialog::xfrStarted(unsigned long bytes)
+{
+	transfer_row_t * row = senderRow();
+	if (! row)
+		return;
+
+	if (! bytes)
+	{
+		row->pbTransfer->setRange(0, 1);
+		row->pbTransfer->setValue(1);
+	}
+	else
+	{
+		row->pbTransfer->setRange(0, bytes);
+	}
+}
+
+void MultiTransferDialog::xfrStats(const transfer_stats_t & stats)
+{
+	transfer_row_t * row = senderRow();
+	if (row)
+		row->stats = stats;
+}
+
+void MultiTransferDialog::xfrStatus(const QString & msg)
+{
+	transfer_row_t * row = senderRow();
+	if (row && row->running)
+		row->lblStatus->setText(msg);
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef MULTITRANSFERDIALOG_HPP_
+#define MULTITRANSFERDIALOG_HPP_
+
+/**
+ * @file src/dialogs/multitransferdialog.hpp
+ * @brief Multiple Dive Computer Transfer Dialog Class
+ * @author Jonathan Krauss <jkrauss@asymworks.com>
+ */
+
+#include <deque>
+#include <vector>
+
+#include <QCheckBox>
+#include <QDialog>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QLabel>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QThreadPool>
+
+/*
+ * FIX for broken Qt4 moc and BOOST_JOIN error
+ */
+#ifdef Q_MOC_RUN
+#define BOOST_NO_TEMPLATE_PARTIAL_SPECIALIZATION
+#endif
+
+#include <benthos/logbook/dive_computer.hpp>
+#include <benthos/logbook/profile.hpp>
+
+#include "workers/transferworker.hpp"
+
+using namespace benthos::logbook;
+
+/**
+ * @brief Multiple Dive Computer Transfer Dialog
+ *
+ * Transfers dives from several dive computers at once.  The dialog lists the
+ * computers with a check box each; once started, every selected computer is
+ * transferred by its own TransferWorker on a thread pool sized to the number
+ * of computers, so one slow device does not hold up the others.  The workers
+ * share one MixTable and divide the parse threads between them.  Each row
+ * shows its device's progress and status.  The workers are not auto-deleted,
+ * so that their signals can be mapped back to their rows until the dialog is
+ * destroyed.
+ *
+ * When a transfer finishes its dives join a single persistence queue which
+ * saves one computer at a time with an ImportWorker, while the remaining
+ * transfers continue.  A failed or cancelled transfer only affects its own
+ * row.  The dialog can be closed once all transfers and imports are done.
+ */
+class MultiTransferDialog: public QDialog
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief Class Constructor
+	 * @param[in] Dive Computers to offer for Transfer
+	 * @param[in] Parent Widget
+	 */
+	MultiTransferDialog(const std::vector<DiveComputer::Ptr> & computers, QWidget * parent = 0);
+
+	//! Class Destructor
+	virtual ~MultiTransferDialog();
+
+public slots:
+
+	//! Cancel running Transfers, or close the Dialog if none are running
+	virtual void reject();
+
+protected slots:
+	void btnStartClicked();
+
+	void importError(const QString &);
+	void importFinished();
+	void importProgress(int);
+
+	void xfrDives(const profile_list_t &);
+	void xfrError(const QString &);
+	void xfrFinished();
+	void xfrParsed(unsigned long);
+	void xfrProgress(unsigned long);
+	void xfrStarted(unsigned long);
+	void xfrStats(const transfer_stats_t &);
+	void xfrStatus(const QString &);
+
+signals:
+	void cancelled();
+
+protected:
+
+	//! Per-Computer Transfer State
+	typedef struct
+	{
+		DiveComputer::Ptr		dc;
+		QCheckBox *				chkName;
+		QProgressBar *			pbTransfer;
+		QLabel *				lblStatus;
+		profile_list_t			dives;
+		transfer_stats_t		stats;
+		bool					running;
+		bool					failed;
+	} transfer_row_t;
+
+	//! @return Row of the Worker which sent the current Signal, or 0
+	transfer_row_t * senderRow();
+
+	//! Start the next queued Import if none is running
+	void persistNext();
+
+	//! Update the Summary Label and the Button State
+	void updateSummary();
+
+private:
+	std::vector<transfer_row_t>		m_rows;
+	QHash<QObject *, int>			m_workers;
+	QThreadPool						m_pool;
+
+	std::deque<int>					m_persistQueue;
+	int								m_persisting;
+	QElapsedTimer					m_persistTimer;
+
+	int								m_running;
+	int								m_saved;
+	int								m_failed;
+	unsigned long					m_savedDives;
+
+	QLabel *						m_lblSummary;
+	QPushButton *					m_btnStart;
+	QPushButton *					m_btnClose;
+
+};
+
+#endif /* MULTITRANSFERDIALOG_HPP_ */
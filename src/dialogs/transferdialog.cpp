@@ -25,13 +25,15 @@
 #include <QPushButton>
 #include <QVBoxLayout>
 
-#include "workers/transferworker.hpp"
 #include "transferdialog.hpp"
 
 TransferDialog::TransferDialog(QWidget * parent)
-	: QDialog(parent), m_lblStatus(0), m_pbTransfer(0), m_dives()
+	: QDialog(parent), m_lblStatus(0), m_lblParsed(0), m_lblRate(0), m_pbTransfer(0), m_dives(),
+	  m_timer(), m_bytes(0), m_parsed(0), m_stats()
 {
 	m_lblStatus = new QLabel;
+	m_lblParsed = new QLabel;
+	m_lblRate = new QLabel;
 	m_pbTransfer = new QProgressBar;
 	m_pbTransfer->setMinimumWidth(400);
 
@@ -46,6 +48,8 @@ TransferDialog::TransferDialog(QWidget * parent)
 	QVBoxLayout * vbox = new QVBoxLayout;
 	vbox->addWidget(m_lblStatus);
 	vbox->addWidget(m_pbTransfer);
+	vbox->addWidget(m_lblParsed);
+	vbox->addWidget(m_lblRate);
 	vbox->addLayout(hbox);
 
 	setLayout(vbox);
@@ -66,9 +70,28 @@ std::vector<Profile::Ptr> TransferDialog::dives() const
 	return m_dives;
 }
 
-void TransferDialog::xfrDive(Profile::Ptr profile)
+const transfer_stats_t & TransferDialog::stats() const
 {
-	m_dives.push_back(profile);
+	return m_stats;
+}
+
+void TransferDialog::updateRate()
+{
+	if (! m_timer.isValid())
+		return;
+
+	double secs = m_timer.elapsed() / 1000.0;
+	if (secs <= 0)
+		return;
+
+	m_lblRate->setText(tr("%1 KB/s, %2 dives/s")
+		.arg(m_bytes / 1024.0 / secs, 0, 'f', 1)
+		.arg(m_parsed / secs, 0, 'f', 1));
+}
+
+void TransferDialog::xfrDives(const profile_list_t & profiles)
+{
+	m_dives.insert(m_dives.end(), profiles.begin(), profiles.end());
 }
 
 void TransferDialog::xfrError(const QString & msg)
@@ -82,9 +105,20 @@ void TransferDialog::xfrFinished()
 	done(QDialog::Accepted);
 }
 
+void TransferDialog::xfrParsed(unsigned long count)
+{
+	m_lblParsed->setText(tr("Parsed %1 dives").arg(count));
+
+	m_parsed = count;
+	updateRate();
+}
+
 void TransferDialog::xfrProgress(unsigned long bytes)
 {
 	m_pbTransfer->setValue(bytes);
+
+	m_bytes = bytes;
+	updateRate();
 }
 
 void TransferDialog::xfrStarted(unsigned long bytes)
@@ -93,6 +127,12 @@ void TransferDialog::xfrStarted(unsigned long bytes)
 		QMessageBox::information(this, tr("Transfer Dives"), tr("No new dives to transfer"));
 
 	m_pbTransfer->setMaximum(bytes);
+	m_timer.start();
+}
+
+void TransferDialog::xfrStats(const transfer_stats_t & stats)
+{
+	m_stats = stats;
 }
 
 void TransferDialog::xfrStatus(const QString & msg)
@@ -32,6 +32,7 @@
 #include <vector>
 
 #include <QDialog>
+#include <QElapsedTimer>
 #include <QLabel>
 #include <QProgressBar>
 #include <QRunnable>
@@ -45,12 +46,15 @@
 
 #include <benthos/logbook/profile.hpp>
 
+#include "workers/transferworker.hpp"
+
 using namespace benthos::logbook;
 
 /**
  * @brief Dive Computer Transfer Dialog
  *
- * Shows the progress of the dive computer transfer operation.
+ * Shows the progress of the dive computer transfer operation, including the
+ * data rate and the dive parsing rate since the transfer started.
  */
 class TransferDialog: public QDialog
 {
@@ -69,12 +73,17 @@ public:
 	//! @return List of Transferred Dives
 	std::vector<Profile::Ptr> dives() const;
 
+	//! @return Transfer Statistics reported by the Worker
+	const transfer_stats_t & stats() const;
+
 public slots:
-	void xfrDive(Profile::Ptr);
+	void xfrDives(const profile_list_t &);
 	void xfrError(const QString &);
 	void xfrFinished();
+	void xfrParsed(unsigned long);
 	void xfrProgress(unsigned long);
 	void xfrStarted(unsigned long);
+	void xfrStats(const transfer_stats_t &);
 	void xfrStatus(const QString &);
 
 protected slots:
@@ -85,9 +94,21 @@ signals:
 
 private:
 	QLabel *					m_lblStatus;
+	QLabel *					m_lblParsed;
+	QLabel *					m_lblRate;
 	QProgressBar *				m_pbTransfer;
 	std::vector<Profile::Ptr>	m_dives;
 
+	QElapsedTimer				m_timer;
+	unsigned long				m_bytes;
+	unsigned long				m_parsed;
+	transfer_stats_t			m_stats;
+
+protected:
+
+	//! Update the Transfer Rate Label
+	void updateRate();
+
 };
 
 #endif /* TRANSFERDIALOG_HPP_ */
@@ -30,11 +30,19 @@
 
 #include "config.hpp"
 #include "mainwindow.hpp"
+#include "mvf/views/profile_cache.hpp"
+#include "mvf/views/sparkline_cache.hpp"
+#include "util/formatcache.hpp"
+#include "workers/profileloadworker.hpp"
+#include "workers/transferworker.hpp"
 
 using namespace benthos::logbook;
 
 // Declare Custom MetaTypes
 Q_DECLARE_METATYPE(Profile::Ptr)
+Q_DECLARE_METATYPE(profile_load_t)
+Q_DECLARE_METATYPE(profile_list_t)
+Q_DECLARE_METATYPE(transfer_stats_t)
 
 class LevelFilter: public logging::log_filter
 {
@@ -122,6 +130,14 @@ int main(int argc, char **  argv)
 
 	// Register Custom Metatypes
 	qRegisterMetaType<Profile::Ptr>();
+	qRegisterMetaType<profile_load_t>("profile_load_t");
+	qRegisterMetaType<profile_list_t>("profile_list_t");
+	qRegisterMetaType<transfer_stats_t>("transfer_stats_t");
+
+	// Create the Caches before any Worker Threads are started
+	FormatCache::Instance();
+	ProfileCache::Instance();
+	SparklineCache::Instance();
 
 	// Load Main Window and Execute
 	MainWindow * w = new MainWindow;
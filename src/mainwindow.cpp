@@ -21,7 +21,9 @@
  */
 
 #include <climits>
+#include <ctime>
 
+#include <QDesktopServices>
 #include <QFileDialog>
 #include <QGridLayout>
 #include <QHBoxLayout>
@@ -37,17 +39,22 @@
 #include "config.hpp"
 #include "mainwindow.hpp"
 
+#include "util/devicecapture.hpp"
+#include "util/formatcache.hpp"
 #include "util/qticonloader.hpp"
 #include "util/units.hpp"
 
 #include "dialogs/aboutdialog.hpp"
 #include "dialogs/modeladddialog.hpp"
 #include "dialogs/modeleditdialog.hpp"
+#include "dialogs/multitransferdialog.hpp"
 #include "dialogs/tanksmixdialog.hpp"
 
 #include "mvf/models/dive_model.hpp"
 #include "mvf/views/dive_stackedview.hpp"
 #include "mvf/views/dive_editpanel.hpp"
+#include "mvf/views/profile_cache.hpp"
+#include "mvf/views/sparkline_cache.hpp"
 
 #include "mvf/models/site_model.hpp"
 #include "mvf/views/site_stackedview.hpp"
@@ -166,7 +173,10 @@ void MainWindow::actMergeDivesTriggered()
 	for (pit = plist.begin(); pit != plist.end(); pit++)
 		m_Logbook->session()->add(* pit);
 	for (it = dives.begin(); it != dives.end(); it++)
+	{
+		ProfileCache::Instance()->invalidate(* it);
 		m_Logbook->session()->delete_(* it);
+	}
 	m_Logbook->session()->add(newDive);
 	m_Logbook->session()->commit();
 }
@@ -190,6 +200,78 @@ void MainWindow::actNewComputerTriggered()
 	//FIXME: NAVTREE, I ADD COMPUTER. Y U NO UPDATE?
 }
 
+void MainWindow::actNewEmulatorTriggered()
+{
+	QStringList sources;
+	sources << tr("Replay a Transfer Capture") << tr("Generate Synthetic Dives");
+
+	bool ok;
+	QString source = QInputDialog::getItem(this, tr("New Emulated Computer"), tr("Dive source:"), sources, 0, false, & ok);
+	if (! ok)
+		return;
+
+	DiveComputer::Ptr dc(new DiveComputer);
+	dc->setDriver(EMULATOR_DRIVER);
+
+	if (source == sources[0])
+	{
+		QString dir = QString("%1/captures").arg(QDesktopServices::storageLocation(QDesktopServices::DataLocation));
+		QString fn = QFileDialog::getOpenFileName(this, tr("Select a Transfer Capture..."), dir, tr("Transfer Captures (*.bxc);;All Files (*.*)"));
+		if (fn.isNull())
+			return;
+
+		DeviceCapture capture;
+		try
+		{
+			capture.load(fn);
+		}
+		catch (std::exception & e)
+		{
+			QMessageBox::critical(this, tr("New Emulated Computer"), QString::fromStdString(e.what()));
+			return;
+		}
+
+		dc->setDevice(fn.toStdString());
+		dc->setSerial(QString::number(capture.serial()).toStdString());
+		dc->setModel(capture.driver());
+		dc->setName(QString("Emulated %1 (%2)").arg(QString::fromStdString(capture.driver())).arg(QFileInfo(fn).fileName()).toStdString());
+	}
+	else
+	{
+		int count = QInputDialog::getInt(this, tr("New Emulated Computer"), tr("Number of synthetic dives:"), 100, 1, EMULATOR_SYNTHETIC_MAX, 1, & ok);
+		if (! ok)
+			return;
+
+		// The serial number seeds the generator, so each computer has its own dives
+		dc->setDevice(QString("%1%2").arg(EMULATOR_SYNTHETIC).arg(count).toStdString());
+		dc->setSerial(QString::number(time(NULL) & 0x7fffffff).toStdString());
+		dc->setName(QString("Synthetic %1 Dives").arg(count).toStdString());
+	}
+
+	double speed = QInputDialog::getDouble(this, tr("New Emulated Computer"), tr("Replay speed (0 for as fast as possible):"), 1.0, 0.0, 1000.0, 2, & ok);
+	if (! ok)
+		return;
+
+	dc->setDriverArgs(QString("speed=%1").arg(speed).toStdString());
+
+	m_Logbook->session()->add(dc);
+	m_Logbook->session()->commit();
+}
+
+void MainWindow::actMultiTransferTriggered()
+{
+	std::vector<DiveComputer::Ptr> computers = m_Logbook->session()->finder<DiveComputer>()->find();
+	if (computers.empty())
+	{
+		QMessageBox::information(this, tr("Transfer from Multiple Computers"), tr("There are no dive computers in the Logbook.  Use 'New Dive Computer...' to add one."));
+		return;
+	}
+
+	MultiTransferDialog d(computers, this);
+	if (d.exec() == QDialog::Accepted)
+		updateView();
+}
+
 void MainWindow::actNewDiveTriggered()
 {
 	DiveModel mdl;
@@ -387,6 +469,7 @@ void MainWindow::actSetImperialTriggered()
 	s.setValue(QString("Unit%1").arg(qtVolume), "Cubic Feet");
 	s.endGroup();
 
+	FormatCache::Instance()->invalidate();
 	update();
 }
 
@@ -403,6 +486,7 @@ void MainWindow::actSetMetricTriggered()
 	s.setValue(QString("Unit%1").arg(qtVolume), "Liters");
 	s.endGroup();
 
+	FormatCache::Instance()->invalidate();
 	update();
 }
 
@@ -463,6 +547,14 @@ void MainWindow::createActions()
 	m_actNewComputer->setStatusTip(tr("Add a new Dive Computer"));
 	connect(m_actNewComputer, SIGNAL(triggered()), this, SLOT(actNewComputerTriggered()));
 
+	m_actNewEmulator = new QAction(tr("New &Emulated Computer..."), this);
+	m_actNewEmulator->setStatusTip(tr("Add a Dive Computer which replays a transfer capture or synthetic dives"));
+	connect(m_actNewEmulator, SIGNAL(triggered()), this, SLOT(actNewEmulatorTriggered()));
+
+	m_actMultiTransfer = new QAction(tr("Transfer from M&ultiple Computers..."), this);
+	m_actMultiTransfer->setStatusTip(tr("Transfer dives from several Dive Computers at once"));
+	connect(m_actMultiTransfer, SIGNAL(triggered()), this, SLOT(actMultiTransferTriggered()));
+
 	m_actNewDive = new QAction(tr("New &Dive..."), this);
 	m_actNewDive->setStatusTip(tr("Manually add a new Dive log entry"));
 	connect(m_actNewDive, SIGNAL(triggered()), this, SLOT(actNewDiveTriggered()));
@@ -660,6 +752,8 @@ void MainWindow::createMenus()
 	m_logbookMenu->addAction(m_actNewDive);
 	m_logbookMenu->addAction(m_actNewDiveSite);
 	m_logbookMenu->addAction(m_actNewComputer);
+	m_logbookMenu->addAction(m_actNewEmulator);
+	m_logbookMenu->addAction(m_actMultiTransfer);
 	m_logbookMenu->addSeparator();
 	m_logbookMenu->addAction(m_actDeleteItems);
 	m_logbookMenu->addSeparator();
@@ -933,6 +1027,8 @@ void MainWindow::updateLogbook()
 	m_svDives->bind(m_Logbook);
 	m_svSites->bind(m_Logbook);
 
+	SparklineCache::Instance()->setLogbook(m_Logbook ? m_LogbookPath : QString());
+
 	m_navTree->expandAll();
 
 	if (m_Logbook)
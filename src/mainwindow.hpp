@@ -133,6 +133,8 @@ private slots:
 	void actViewDetailsTriggered();
 
 	void actNewComputerTriggered();
+	void actNewEmulatorTriggered();
+	void actMultiTransferTriggered();
 	void actNewDiveTriggered();
 	void actNewDiveSiteTriggered();
 	void actDeleteItemsTriggered();
@@ -156,6 +158,8 @@ private:
 	QAction *				m_actExit;
 
 	QAction *				m_actNewComputer;
+	QAction *				m_actNewEmulator;
+	QAction *				m_actMultiTransfer;
 	QAction *				m_actNewDive;
 	QAction *				m_actNewDiveSite;
 	QAction *				m_actDeleteItems;
@@ -32,11 +32,33 @@
 #include <QModelIndex>
 #include <QPainter>
 #include <QRegExp>
-#include <QSettings>
 #include <QStyleOptionViewItem>
 
+#include "util/formatcache.hpp"
 #include "delegates.hpp"
 
+static QString formatDateTime(const QVariant & value)
+{
+	return value.toDateTime().toString(FormatCache::Instance()->dateTimeFormat());
+}
+
+static QString formatTitleCase(const QVariant & value)
+{
+	QString val = value.toString().replace('_', ' ');
+	if (val.isNull() || val.isEmpty())
+		return QString();
+
+	QRegExp rx("(^|\\b+)(\\w)");
+	int i = 0;
+	while ((i = rx.indexIn(val, i)) != -1)
+	{
+		val[i+rx.cap(1).length()] = rx.cap(2).toUpper().at(0);
+		i += rx.matchedLength();
+	}
+
+	return val;
+}
+
 CustomDelegate::CustomDelegate(QObject * parent)
 	: QStyledItemDelegate(parent)
 {
@@ -206,19 +228,7 @@ TitleCaseDelegate::~TitleCaseDelegate()
 
 QString TitleCaseDelegate::displayText(const QVariant & value, const QLocale & locale) const
 {
-	QString val = value.toString().replace('_', ' ');
-	if (val.isNull() || val.isEmpty())
-		return QString();
-
-	QRegExp rx("(^|\\b+)(\\w)");
-	int i = 0;
-	while ((i = rx.indexIn(val, i)) != -1)
-	{
-		val[i+rx.cap(1).length()] = rx.cap(2).toUpper().at(0);
-		i += rx.matchedLength();
-	}
-
-	return val;
+	return FormatCache::Instance()->format("titlecase", value, & formatTitleCase);
 }
 
 PositionDelegate::PositionDelegate(QObject * parent)
@@ -254,17 +264,9 @@ QString UnitDelegate::displayText(const QVariant & value, const QLocale & locale
 	unit_t u;
 
 	//! Lookup the Unit Abbreviation
-	QSettings s;
-	s.beginGroup("Settings");
-	QVariant uname = s.value(QString("Unit%1").arg(m_quantity));
-	s.endGroup();
-
 	try
 	{
-		if (! uname.isValid())
-			u = findUnit(m_quantity, m_unit);
-		else
-			u = findUnit(m_quantity, (const char *)uname.toByteArray());
+		u = FormatCache::Instance()->unit(m_quantity, m_unit);
 	}
 	catch (std::runtime_error & e)
 	{
@@ -286,12 +288,7 @@ DateTimeDelegate::~DateTimeDelegate()
 
 QString DateTimeDelegate::displayText(const QVariant & value, const QLocale & locale) const
 {
-	QSettings s;
-	s.beginGroup("Settings");
-	QVariant fmt = s.value(QString("DTFormat"), QString("MM/dd/yy hh:mm AP"));
-	s.endGroup();
-
-	return value.toDateTime().toString(fmt.toString());
+	return FormatCache::Instance()->format("datetime", value, & formatDateTime);
 }
 
 MinutesDelegate::MinutesDelegate(QObject * parent)
@@ -0,0 +1,71 @@
+/*
+ * Copyright (C) 2012 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <QImage>
+
+#include <mvf/models.hpp>
+#include <mvf/views/sparkline_cache.hpp>
+#include "sparkline_delegate.hpp"
+
+SparklineDelegate::SparklineDelegate(QObject * parent)
+	: NoFocusDelegate(parent)
+{
+}
+
+SparklineDelegate::~SparklineDelegate()
+{
+}
+
+void SparklineDelegate::paint(QPainter * painter, const QStyleOptionViewItem & option, const QModelIndex & index) const
+{
+	painter->save();
+	drawBackground(painter, option, index);
+
+	Dive::Ptr dive;
+	QModelIndex idx = removeProxyModels<LogbookQueryModel<Dive> >(index);
+	if (idx.isValid())
+		dive = ((LogbookQueryModel<Dive> *)idx.model())->item(idx);
+
+	QSize sz = SparklineCache::thumbnailSize();
+	QRect r(QPoint(0, 0), sz);
+	r.moveCenter(option.rect.center());
+
+	QImage img;
+	if (SparklineCache::Instance()->thumbnail(dive, img))
+	{
+		if (! img.isNull())
+			painter->drawImage(r.topLeft(), img);
+	}
+	else if (dive)
+	{
+		// Placeholder until the Thumbnail is Rendered
+		painter->setPen(QColor(208, 208, 208, 255));
+		painter->drawLine(r.left(), r.center().y(), r.right(), r.center().y());
+	}
+
+	painter->restore();
+}
+
+QSize SparklineDelegate::sizeHint(const QStyleOptionViewItem & option, const QModelIndex & index) const
+{
+	return SparklineCache::thumbnailSize() + QSize(4, 4);
+}
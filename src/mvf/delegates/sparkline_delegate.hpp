@@ -0,0 +1,65 @@
+/*
+ * Copyright (C) 2012 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef SPARKLINE_DELEGATE_HPP_
+#define SPARKLINE_DELEGATE_HPP_
+
+/**
+ * @file src/mvf/sparkline_delegate.hpp
+ * @brief Delegate for Profile Sparklines
+ * @author Jonathan Krauss <jkrauss@asymworks.com>
+ */
+
+#include <QModelIndex>
+#include <QPainter>
+#include <QSize>
+#include <QStyleOptionViewItem>
+
+#include <mvf/delegates.hpp>
+
+/**
+ * @brief Profile Sparkline Delegate
+ *
+ * Draws a small depth profile thumbnail for the dive in the row.  Thumbnails
+ * come from the SparklineCache; if one is not ready yet a placeholder line is
+ * drawn and the view is repainted when the cache emits thumbnailReady().
+ */
+class SparklineDelegate: public NoFocusDelegate
+{
+public:
+
+	//! Class Constructor
+	SparklineDelegate(QObject * parent = 0);
+
+	//! Class Destructor
+	virtual ~SparklineDelegate();
+
+public:
+
+	//! Paint the Sparkline
+	virtual void paint(QPainter * painter, const QStyleOptionViewItem & option, const QModelIndex & index) const;
+
+	//! @return Size Hint
+	virtual QSize sizeHint(const QStyleOptionViewItem & option, const QModelIndex & index) const;
+
+};
+
+#endif /* SPARKLINE_DELEGATE_HPP_ */
@@ -379,6 +379,61 @@ protected:
 
 };
 
+/**
+ * @brief Null Field Adapter Class
+ *
+ * Field adapter which returns no data for any role.  Used for columns which
+ * are drawn entirely by their delegate from the row object, such as the dive
+ * profile sparkline.
+ */
+template <class T>
+class NullFieldAdapter: public IFieldAdapter<T>
+{
+public:
+
+	//! Class Constructor
+	NullFieldAdapter()
+	{
+	}
+
+	//! Class Destructor
+	virtual ~NullFieldAdapter()
+	{
+	}
+
+public:
+
+	//! @param[in] Session Pointer
+	virtual void bind(logbook::Session::Ptr session)
+	{
+	}
+
+	//! @return Decoration Value for the Field
+	virtual QVariant decorationData(const boost::shared_ptr<T> &) const
+	{
+		return QVariant();
+	}
+
+	//! @return Display Value for the Field
+	virtual QVariant displayData(const boost::shared_ptr<T> &) const
+	{
+		return QVariant();
+	}
+
+	//! @return Edit Value for the Field
+	virtual QVariant editData(const boost::shared_ptr<T> &) const
+	{
+		return QVariant();
+	}
+
+	//! @brief Set the Edit Value for the Field
+	virtual bool setEditData(boost::shared_ptr<T> &, const QVariant &) const
+	{
+		return false;
+	}
+
+};
+
 /**
  * @brief Enumerated Field Adapter Class
  *
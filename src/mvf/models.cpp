@@ -22,13 +22,23 @@
 
 #include "models.hpp"
 
+std::set<CustomTableModel *> CustomTableModel::m_models;
+int CustomTableModel::m_bulkDepth = 0;
+
 CustomTableModel::CustomTableModel(QObject * parent)
 	: QAbstractTableModel(parent), m_session()
 {
+	m_models.insert(this);
 }
 
 CustomTableModel::~CustomTableModel()
 {
+	m_models.erase(this);
+}
+
+void CustomTableModel::beginBulkUpdate()
+{
+	++m_bulkDepth;
 }
 
 void CustomTableModel::bind(Session::Ptr session)
@@ -46,6 +56,11 @@ const std::vector<BaseModelColumn *> & CustomTableModel::columns() const
 	return m_columns;
 }
 
+bool CustomTableModel::bulkUpdating()
+{
+	return (m_bulkDepth > 0);
+}
+
 void CustomTableModel::emitDataChanged(const QModelIndex & topLeft, const QModelIndex & bottomRight)
 {
 	emit dataChanged(topLeft, bottomRight);
@@ -79,6 +94,20 @@ int CustomTableModel::findColumn(const QString & col) const
 	return -1;
 }
 
+void CustomTableModel::endBulkUpdate()
+{
+	if ((m_bulkDepth == 0) || (--m_bulkDepth > 0))
+		return;
+
+	std::set<CustomTableModel *>::const_iterator it;
+	for (it = m_models.begin(); it != m_models.end(); it++)
+		(* it)->on_bulk_end();
+}
+
 void CustomTableModel::on_bind(Session::Ptr)
 {
 }
+
+void CustomTableModel::on_bulk_end()
+{
+}
@@ -29,6 +29,9 @@
  * @author Jonathan Krauss <jkrauss@asymworks.com>
  */
 
+#include <algorithm>
+#include <set>
+
 #include <boost/any.hpp>
 #include <boost/signals2.hpp>
 
@@ -85,6 +88,12 @@ QModelIndex removeProxyModels(const QModelIndex & index)
  * Shim model which wraps the dataChanged signal in a method since Q_OBJECT
  * is not supported by templated classes.  This class also carries the column
  * list vector so it can be supported by views that don't need the template.
+ *
+ * Bulk updates (such as importing a large transfer) can be bracketed with the
+ * static beginBulkUpdate() and endBulkUpdate() methods.  While a bulk update
+ * is in progress models ignore per-item mapper and attribute events, and when
+ * the last bulk update ends each model is given a single chance to refresh
+ * through the on_bulk_end() hook, which also reports every row as changed.  Both methods must be called from the GUI thread.
  */
 class CustomTableModel: public QAbstractTableModel
 {
@@ -113,15 +122,33 @@ public:
 	//! @return Column Index
 	int findColumn(const QString & col) const;
 
+public:
+
+	//! Suspend per-Item Model Notifications in all Models
+	static void beginBulkUpdate();
+
+	//! @return If a Bulk Update is in Progress
+	static bool bulkUpdating();
+
+	//! Resume Model Notifications and Refresh all Models
+	static void endBulkUpdate();
+
 protected:
 
 	//! Called when the Model is bound to a Session
 	virtual void on_bind(Session::Ptr);
 
+	//! Called when the last Bulk Update has ended
+	virtual void on_bulk_end();
+
 protected:
 	std::vector<BaseModelColumn *>		m_columns;
 	Session::Ptr						m_session;
 
+private:
+	static std::set<CustomTableModel *>	m_models;
+	static int							m_bulkDepth;
+
 };
 
 /**
@@ -199,6 +226,65 @@ public:
 		endResetModel();
 	}
 
+	/**
+	 * @brief Incrementally Refresh the Items from the Data Source
+	 *
+	 * Re-queries the data source once, removes rows whose items are gone and
+	 * inserts new items in contiguous runs.  The relative order of existing
+	 * items is assumed to be unchanged.
+	 */
+	void refreshFromSource()
+	{
+		if (! m_source || ! m_session)
+			return;
+
+		std::vector<boost::shared_ptr<T> > newItems = m_source->getItems(m_session);
+		std::set<boost::shared_ptr<T> > newSet(newItems.begin(), newItems.end());
+		std::set<boost::shared_ptr<T> > oldSet;
+
+		// Remove Rows for deleted Items
+		for (int r = (int)m_items.size() - 1; r >= 0; --r)
+		{
+			if (newSet.find(m_items[r]) != newSet.end())
+			{
+				oldSet.insert(m_items[r]);
+				continue;
+			}
+
+			beginRemoveRows(QModelIndex(), r, r);
+			m_items.erase(m_items.begin() + r);
+			endRemoveRows();
+		}
+
+		// Insert new Items in contiguous Runs
+		size_t i = 0;
+		while (i < newItems.size())
+		{
+			if (oldSet.find(newItems[i]) != oldSet.end())
+			{
+				++i;
+				continue;
+			}
+
+			size_t j = i;
+			while ((j < newItems.size()) && (oldSet.find(newItems[j]) == oldSet.end()))
+				++j;
+
+			beginInsertRows(QModelIndex(), i, j - 1);
+			m_items.insert(m_items.begin() + i, newItems.begin() + i, newItems.begin() + j);
+			endInsertRows();
+
+			i = j;
+		}
+
+		if (! m_evtAttrSet.connected() && ! m_items.empty())
+		{
+			Persistent::Ptr pobj = boost::dynamic_pointer_cast<Persistent>(m_items[0]);
+			if (pobj)
+				m_evtAttrSet = pobj->events().attr_set.connect(boost::bind(& LogbookQueryModel<T>::evtAttrSet, this, _1, _2, _3));
+		}
+	}
+
 	//! Clear the Items
 	void clearItems()
 	{
@@ -333,6 +419,9 @@ public:
 	 */
 	void evtAttrSet(Persistent::Ptr obj, const std::string & field, const boost::any & value)
 	{
+		if (bulkUpdating())
+			return;
+
 		boost::shared_ptr<T> item = boost::dynamic_pointer_cast<T>(obj);
 		if (! item)
 			return;
@@ -362,6 +451,9 @@ public:
 		 * removeRows() directly.  Do not use as a replacement for removeRows().
 		 */
 
+		if (bulkUpdating())
+			return;
+
 		boost::shared_ptr<T> item = boost::dynamic_pointer_cast<T>(obj);
 		if (! item)
 			return;
@@ -383,7 +475,7 @@ public:
 	 */
 	void evtItemInserted(AbstractMapper::Ptr, Persistent::Ptr obj)
 	{
-		if (! m_source || ! m_session)
+		if (! m_source || ! m_session || bulkUpdating())
 			return;
 
 		boost::shared_ptr<T> item = boost::dynamic_pointer_cast<T>(obj);
@@ -422,6 +514,19 @@ protected:
 		}
 	}
 
+	//! Called when the last Bulk Update has ended
+	virtual void on_bulk_end()
+	{
+		refreshFromSource();
+
+		/*
+		 * Attribute events were dropped during the Bulk Update, so repaint
+		 * the retained Rows as well as the inserted ones
+		 */
+		if (! m_items.empty() && (columnCount() > 0))
+			emitDataChanged(index(0, 0), index((int)m_items.size() - 1, columnCount() - 1));
+	}
+
 protected:
 	std::vector<boost::shared_ptr<T> >		m_items;
 	ILogbookDataSource<T> *					m_source;
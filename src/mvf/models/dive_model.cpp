@@ -21,6 +21,7 @@
  */
 
 #include "mvf/delegates.hpp"
+#include "mvf/delegates/sparkline_delegate.hpp"
 #include "dive_model.hpp"
 
 #include <benthos/logbook/dive_computer.hpp>
@@ -151,6 +152,11 @@ DiveModel::DiveModel(QObject * parent)
 			)
 		), "tank", "Primary Tank"
 	));
+
+	m_columns.push_back(new ModelColumn<LogbookQueryModel::model_type>(
+		new NullFieldAdapter<LogbookQueryModel::model_type>,
+		"profile", "Profile", new DelegateFactory<SparklineDelegate>
+	));
 }
 
 DiveModel::~DiveModel()
@@ -246,15 +252,12 @@ std::vector<Profile::Ptr> DiveModel::Merge(const std::vector<Dive::Ptr> & dives_
 			int last = 0;
 			int diff = 0;
 
+			const std::list<waypoint> & src = (* pit)->profile();
 			std::list<waypoint>::const_iterator wit;
-			for (wit = (* pit)->profile().begin(); wit != (* pit)->profile().end(); wit++)
+			for (wit = src.begin(); wit != src.end(); wit++)
 			{
-				waypoint w;
-				w.time = wit->time + offset;
-				w.mix = wit->mix;
-				w.alarms = wit->alarms;
-				w.data = wit->data;
-				waypoints.push_back(w);
+				waypoints.push_back(* wit);
+				waypoints.back().time += offset;
 
 				diff = wit->time - last;
 				last = wit->time;
@@ -277,11 +280,11 @@ std::vector<Profile::Ptr> DiveModel::Merge(const std::vector<Dive::Ptr> & dives_
 	if (dc && (merge_profiles.find(dc) != merge_profiles.end()))
 	{
 		Profile::Ptr pFirst = * merge_profiles.at(dc).begin();
-		std::list<waypoint>::const_iterator wit = pFirst->profile().end();
-		--wit;
-
-		int wduration = wit->time / 60 + 1;
-		extra = wduration - dFirst->duration();
+		if (! pFirst->profile().empty())
+		{
+			int wduration = (int)pFirst->profile().back().time / 60 + 1;
+			extra = wduration - dFirst->duration();
+		}
 	}
 
 	/*
@@ -76,6 +76,7 @@ using namespace benthos::logbook;
  * 33: Weight
  * 34: Primary Tank (FK)
  * 35: Primary Tank Name
+ * 36: Profile Sparkline
  */
 class DiveModel: public LogbookQueryModel<Dive>
 {
@@ -25,7 +25,10 @@
 #include <string>
 
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QHBoxLayout>
+#include <QMessageBox>
+#include <QProgressDialog>
 #include <QSettings>
 #include <QThreadPool>
 #include <QVBoxLayout>
@@ -37,9 +40,12 @@
 
 #include "dialogs/driverparamsdialog.hpp"
 #include "dialogs/transferdialog.hpp"
+#include "mvf/models.hpp"
+#include "workers/importworker.hpp"
 #include "workers/transferworker.hpp"
 
 #include "computer_view.hpp"
+#include "profile_cache.hpp"
 #include "config.hpp"
 
 using namespace benthos::dc;
@@ -100,37 +106,77 @@ void ComputerView::btnTransferClicked()
 	QThreadPool * tp = QThreadPool::globalInstance();
 	TransferWorker * worker = new TransferWorker(m_dc, m_dc->session(), checkSN, updateToken);
 
+	if (m_chkCapture->isChecked())
+		worker->setCaptureFile(DeviceCapture::capturePath(m_dc->driver(), m_dc->serial()));
+
 	// Create the Progress Dialog
 	TransferDialog * dialog = new TransferDialog(this);
 
 	// Connect Signals/Slots
 	connect(worker, SIGNAL(finished()), dialog, SLOT(xfrFinished()), Qt::QueuedConnection);
-	connect(worker, SIGNAL(parsedDive(Profile::Ptr)), dialog, SLOT(xfrDive(Profile::Ptr)), Qt::QueuedConnection);
+	connect(worker, SIGNAL(parsedDives(const profile_list_t &)), dialog, SLOT(xfrDives(const profile_list_t &)), Qt::QueuedConnection);
+	connect(worker, SIGNAL(parsed(unsigned long)), dialog, SLOT(xfrParsed(unsigned long)), Qt::QueuedConnection);
 	connect(worker, SIGNAL(progress(unsigned long)), dialog, SLOT(xfrProgress(unsigned long)), Qt::QueuedConnection);
 	connect(worker, SIGNAL(started(unsigned long)), dialog, SLOT(xfrStarted(unsigned long)), Qt::QueuedConnection);
+	connect(worker, SIGNAL(stats(const transfer_stats_t &)), dialog, SLOT(xfrStats(const transfer_stats_t &)), Qt::QueuedConnection);
 	connect(worker, SIGNAL(status(const QString &)), dialog, SLOT(xfrStatus(const QString &)), Qt::QueuedConnection);
 	connect(worker, SIGNAL(transferError(const QString &)), dialog, SLOT(xfrError(const QString &)), Qt::QueuedConnection);
 
 	connect(dialog, SIGNAL(cancelled()), worker, SLOT(cancel()), Qt::QueuedConnection);
 
 	// Run the Transfer
+	worker->prepare();
 	tp->start(worker);
 	if (dialog->exec() == QDialog::Accepted)
 	{
-		//FIXME: Be less dumb when merging dives
+		// Dives already in the logbook were dropped by the TransferWorker
 		std::vector<Profile::Ptr> dives = dialog->dives();
 		std::vector<Profile::Ptr>::iterator it;
-		for (it = dives.begin(); it != dives.end(); it++)
-			m_dc->session()->add(* it);
 
+		if (! dialog->stats().token.empty())
+			m_dc->setToken(dialog->stats().token);
 		m_dc->setLastTransfer(time(NULL));
-		m_dc->session()->add(m_dc);
-		m_dc->session()->commit();
+
+		QElapsedTimer t;
+		t.start();
+		importDives(dives);
+
+		transfer_stats_t stats = dialog->stats();
+		stats.persistMs = t.elapsed();
+		logTransferStats(m_dc, stats);
+
+		for (it = dives.begin(); it != dives.end(); it++)
+			ProfileCache::Instance()->invalidate(* it);
 
 		setComputer(m_dc);
 	}
 }
 
+void ComputerView::importDives(const std::vector<Profile::Ptr> & dives)
+{
+	ImportWorker * worker = new ImportWorker(m_dc->session(), dives, m_dc);
+
+	QProgressDialog progress(tr("Saving %1 dives to the logbook...").arg(dives.size()), QString(), 0, dives.size(), this);
+	progress.setWindowModality(Qt::WindowModal);
+	progress.setMinimumDuration(500);
+
+	connect(worker, SIGNAL(progress(int)), & progress, SLOT(setValue(int)), Qt::QueuedConnection);
+	connect(worker, SIGNAL(importError(const QString &)), this, SLOT(importError(const QString &)), Qt::QueuedConnection);
+	connect(worker, SIGNAL(finished()), & progress, SLOT(accept()), Qt::QueuedConnection);
+	connect(worker, SIGNAL(finished()), worker, SLOT(deleteLater()));
+
+	// Suspend per-row Model Updates until the Import is done
+	CustomTableModel::beginBulkUpdate();
+	worker->start();
+	progress.exec();
+	CustomTableModel::endBulkUpdate();
+}
+
+void ComputerView::importError(const QString & msg)
+{
+	QMessageBox::critical(this, tr("Transfer Dives"), tr("Failed to save the transferred dives: %1").arg(msg));
+}
+
 DiveComputer::Ptr ComputerView::computer() const
 {
 	return m_dc;
@@ -254,9 +300,11 @@ QFrame * ComputerView::createOptionsLayout()
 
 	m_chkCheckSN = new QCheckBox(tr("Verify Serial Number before Transfer"));
 	m_chkUpdateToken = new QCheckBox(tr("Only Download New Dives"));
+	m_chkCapture = new QCheckBox(tr("Save a Capture of each Transfer"));
 
 	connect(m_chkCheckSN, SIGNAL(clicked()), this, SLOT(updateSettings()));
 	connect(m_chkUpdateToken, SIGNAL(clicked()), this, SLOT(updateSettings()));
+	connect(m_chkCapture, SIGNAL(clicked()), this, SLOT(updateSettings()));
 
 	// Label/Value Grid Box
 	QGridLayout * gbox = new QGridLayout;
@@ -301,6 +349,7 @@ QFrame * ComputerView::createOptionsLayout()
 	vbox3->addSpacing(8);
 	vbox3->addWidget(m_chkCheckSN);
 	vbox3->addWidget(m_chkUpdateToken);
+	vbox3->addWidget(m_chkCapture);
 
 	// Create the Frame
 	QFrame * fOptions = new QFrame;
@@ -387,11 +436,16 @@ void ComputerView::setComputer(DiveComputer::Ptr value)
 	s.beginGroup(QString("DiveComputer-%1").arg(m_dc->id()));
 	QVariant checksn = s.value("checksn", Qt::Checked);
 	QVariant update = s.value("update", Qt::Checked);
+	QVariant capture = s.value("capture", Qt::Unchecked);
 	s.endGroup();
 
 	m_lblImage->setPixmap(QPixmap(imagePath(m_dc).c_str()));
 	m_chkCheckSN->setCheckState((Qt::CheckState)checksn.toInt());
 	m_chkUpdateToken->setCheckState((Qt::CheckState)update.toInt());
+	m_chkCapture->setCheckState((Qt::CheckState)capture.toInt());
+
+	// The Emulator has no Driver Plugin to configure
+	m_btnConnection->setEnabled(m_dc->driver() != EMULATOR_DRIVER);
 
 	if (! m_dc->name())
 		m_lblName->clear();
@@ -445,6 +499,7 @@ void ComputerView::updateSettings()
 	s.beginGroup(QString("DiveComputer-%1").arg(m_dc->id()));
 	s.setValue("checksn", m_chkCheckSN->checkState());
 	s.setValue("update", m_chkUpdateToken->checkState());
+	s.setValue("capture", m_chkCapture->checkState());
 	s.endGroup();
 }
 
@@ -30,6 +30,7 @@
  */
 
 #include <string>
+#include <vector>
 
 #include <QCheckBox>
 #include <QFrame>
@@ -48,6 +49,8 @@
 #include <benthos/logbook/dive_computer.hpp>
 #include <benthos/logbook/profile.hpp>
 
+#include "workers/transferworker.hpp"
+
 using namespace benthos::logbook;
 
 /**
@@ -80,6 +83,7 @@ protected slots:
 	void btnConnectionClicked();
 	void btnTransferClicked();
 
+	void importError(const QString &);
 	void updateSettings();
 
 protected:
@@ -96,6 +100,9 @@ protected:
 	//! Create View Layout
 	void createLayout();
 
+	//! Save Transferred Dives to the Logbook in Batches on the GUI Thread
+	void importDives(const std::vector<Profile::Ptr> & dives);
+
 private:
 	DiveComputer::Ptr			m_dc;
 
@@ -117,6 +124,7 @@ private:
 
 	QCheckBox *					m_chkCheckSN;
 	QCheckBox *					m_chkUpdateToken;
+	QCheckBox *					m_chkCapture;
 
 	QPushButton *				m_btnConnection;
 
@@ -25,11 +25,21 @@
 #include <QVBoxLayout>
 
 #include <mvf/models.hpp>
+#include <mvf/views/profile_cache.hpp>
+#include <mvf/views/sparkline_cache.hpp>
+#include <workers/prefetchworker.hpp>
 #include "dive_profileview.hpp"
 
+//! Maximum Number of Rows to Prefetch in the Scroll Direction
+#define PREFETCH_MAX_PAGE	25
+
 DiveProfileView::DiveProfileView(QWidget * parent)
-	: QWidget(parent), m_listview(0), m_profile(0), m_splitter(0)
+	: QWidget(parent), m_listview(0), m_profile(0), m_splitter(0), m_prefetchPool(0),
+	  m_prefetchGen(0)
 {
+	m_prefetchPool = new QThreadPool(this);
+	m_prefetchPool->setMaxThreadCount(1);
+
 	m_listview = new MultiColumnListView;
 	m_listview->setSortingEnabled(true);
 	m_listview->sortByColumn(-1, Qt::AscendingOrder);
@@ -43,6 +53,9 @@ DiveProfileView::DiveProfileView(QWidget * parent)
 	connect(m_listview, SIGNAL(currentIndexChanged(const QModelIndex &, const QModelIndex &)), this, SLOT(onCurrentIndexChanged(const QModelIndex &, const QModelIndex &)));
 	connect(m_listview, SIGNAL(currentSelectionChanged(const QItemSelection &, const QItemSelection &)), this, SLOT(onCurrentSelectionChanged(const QItemSelection &, const QItemSelection &)));
 
+	// Repaint the Sparkline Column as Thumbnails finish rendering
+	connect(SparklineCache::Instance(), SIGNAL(thumbnailReady(qlonglong)), m_listview->viewport(), SLOT(update()));
+
 	m_profile = new ProfileView;
 
 	m_splitter = new QSplitter;
@@ -63,6 +76,9 @@ DiveProfileView::DiveProfileView(QWidget * parent)
 
 DiveProfileView::~DiveProfileView()
 {
+	// Cancel any pending Prefetch before the Generation Counter is destroyed
+	m_prefetchGen.ref();
+	m_prefetchPool->waitForDone();
 }
 
 void DiveProfileView::clearSelection()
@@ -78,6 +94,18 @@ void DiveProfileView::clearSelection()
 	onCurrentSelectionChanged(QItemSelection(), QItemSelection());
 }
 
+Dive::Ptr DiveProfileView::diveForIndex(const QModelIndex & index)
+{
+	if (! index.isValid())
+		return Dive::Ptr();
+
+	QModelIndex idx = removeProxyModels<LogbookQueryModel<Dive> >(index);
+	if (! idx.isValid())
+		return Dive::Ptr();
+
+	return ((LogbookQueryModel<Dive> *)idx.model())->item(idx);
+}
+
 QModelIndex DiveProfileView::currentIndex() const
 {
 	return m_listview->currentIndex();
@@ -121,17 +149,8 @@ void DiveProfileView::onSplitterMoved(int arg1, int arg2)
 
 void DiveProfileView::onCurrentIndexChanged(const QModelIndex & current, const QModelIndex & previous)
 {
-	if (current.isValid())
-	{
-		QModelIndex idx = removeProxyModels<LogbookQueryModel<Dive> >(current);
-		if (! idx.isValid())
-			m_profile->setDive(Dive::Ptr());
-		m_profile->setDive(((LogbookQueryModel<Dive> *)idx.model())->item(idx));
-	}
-	else
-	{
-		m_profile->setDive(Dive::Ptr());
-	}
+	m_profile->setDive(diveForIndex(current));
+	prefetch(current, previous);
 
 	emit currentIndexChanged(current, previous);
 }
@@ -141,6 +160,62 @@ void DiveProfileView::onCurrentSelectionChanged(const QItemSelection & arg1, con
 	emit currentSelectionChanged(arg1, arg2);
 }
 
+void DiveProfileView::prefetch(const QModelIndex & current, const QModelIndex & previous)
+{
+	// Superseded Workers exit as soon as they see the new Generation
+	int serial = m_prefetchGen.fetchAndAddOrdered(1) + 1;
+
+	if (! current.isValid())
+		return;
+
+	const QAbstractItemModel * model = current.model();
+	int row = current.row();
+	int nrows = model->rowCount(current.parent());
+	int dir = (previous.isValid() && (previous.row() > row)) ? -1 : 1;
+
+	/*
+	 * Estimate the Page Size from the List View Geometry
+	 */
+	int page = 0;
+	int rh = m_listview->sizeHintForRow(row);
+	if (rh > 0)
+		page = m_listview->viewport()->height() / rh;
+	if (page > PREFETCH_MAX_PAGE)
+		page = PREFETCH_MAX_PAGE;
+
+	/*
+	 * Build the Prefetch List: immediate neighbours first (in the scroll
+	 * direction), then the rest of the next page.
+	 */
+	std::vector<int> rows;
+	rows.push_back(row + dir);
+	rows.push_back(row - dir);
+	for (int i = 2; i <= page; ++i)
+		rows.push_back(row + dir * i);
+
+	/*
+	 * Resolve the Profiles here, since the Session may only be used from the
+	 * GUI thread; the worker only decodes them.
+	 */
+	std::vector<Profile::Ptr> profiles;
+	std::vector<int>::const_iterator it;
+	for (it = rows.begin(); it != rows.end(); it++)
+	{
+		if ((* it < 0) || (* it >= nrows))
+			continue;
+
+		Dive::Ptr d = diveForIndex(model->index(* it, 0, current.parent()));
+		if (! d)
+			continue;
+
+		std::vector<Profile::Ptr> pl = ProfileCache::Instance()->profiles(d);
+		profiles.insert(profiles.end(), pl.begin(), pl.end());
+	}
+
+	if (! profiles.empty())
+		m_prefetchPool->start(new PrefetchWorker(profiles, & m_prefetchGen, serial));
+}
+
 void DiveProfileView::saveState(QSettings & s)
 {
 	m_listview->saveState(s);
@@ -29,7 +29,9 @@
  * @author Jonathan Krauss <jkrauss@asymworks.com>
  */
 
+#include <QAtomicInt>
 #include <QSplitter>
+#include <QThreadPool>
 #include <QTreeView>
 #include <QWidget>
 
@@ -97,11 +99,30 @@ signals:
 	void currentIndexChanged(const QModelIndex &, const QModelIndex &);
 	void currentSelectionChanged(const QItemSelection &, const QItemSelection &);
 
+protected:
+
+	//! @return Dive for a List View Index
+	static Dive::Ptr diveForIndex(const QModelIndex & index);
+
+	/**
+	 * @brief Prefetch the Profiles around the Current Index
+	 * @param[in] Current Index
+	 * @param[in] Previous Index
+	 *
+	 * Cancels any pending prefetch and queues the dives immediately above and
+	 * below the current index, followed by the next page of dives in the
+	 * direction the selection is moving.
+	 */
+	void prefetch(const QModelIndex & current, const QModelIndex & previous);
+
 private:
 	MultiColumnListView *		m_listview;
 	ProfileView *				m_profile;
 	QSplitter *					m_splitter;
 
+	QThreadPool *				m_prefetchPool;
+	QAtomicInt					m_prefetchGen;
+
 };
 
 #endif /* DIVE_PROFILEVIEW_HPP_ */
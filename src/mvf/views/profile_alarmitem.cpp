@@ -20,14 +20,14 @@
  * 02110-1301, USA.
  */
 
-#include <QGridLayout>
-#include <QLabel>
 #include <QPixmap>
+#include <QTextDocument>
+#include <QVBoxLayout>
 
 #include "profile_alarmitem.hpp"
 
 AlarmPlotItem::AlarmPlotItem(QCustomPlot * parentPlot)
-	: QCPItemPixmap(parentPlot), m_names(), m_tstart(0), m_tend(0), m_popup(0)
+	: QCPItemPixmap(parentPlot), m_names(), m_tstart(0), m_tend(0)
 {
 	setPixmap(QPixmap(":/icons/plot-warning.png"));
 	setSelectedPen(Qt::NoPen);
@@ -37,8 +37,9 @@ AlarmPlotItem::AlarmPlotItem(QCustomPlot * parentPlot)
 
 AlarmPlotItem::~AlarmPlotItem()
 {
-	if (m_popup)
-		m_popup->hide();
+	QFrame * p = parentPlot()->findChild<QFrame *>("AlarmPopup");
+	if (p && (p->property("owner").value<void *>() == this))
+		p->hide();
 }
 
 void AlarmPlotItem::addAlarm(unsigned int time, const QString & name, const QString & desc)
@@ -64,50 +65,73 @@ unsigned int AlarmPlotItem::end_time() const
 	return m_tend;
 }
 
-void AlarmPlotItem::finalize()
-{
-	QGridLayout * gbox = new QGridLayout;
-
-	int row = 0;
-	QMap<unsigned int, QStringList>::const_iterator it;
-	for (it = m_names.begin(); it != m_names.end(); it++)
-	{
-		QLabel * ltime = new QLabel(tr("At %1:%2").arg(it.key() / 60).arg(it.key() % 60, 2, 10, QChar('0')));
-		QLabel * lname = new QLabel(it->join("\n"));
-		lname->setStyleSheet("QLabel { font-weight: bold; }");
-
-		gbox->addWidget(ltime, row, 0);
-		gbox->addWidget(lname, row, 1);
-
-		++row;
-	}
-
-	m_popup = new QFrame(parentPlot(), Qt::ToolTip);
-	m_popup->setFrameStyle(QFrame::StyledPanel | QFrame::Sunken);
-	m_popup->setLayout(gbox);
-	m_popup->setMaximumWidth(100);
-	m_popup->show();
-	m_popup->hide();
-}
-
 void AlarmPlotItem::onSelectionChanged(bool selected)
 {
 	if (selected)
 	{
+		QFrame * p = popup(parentPlot());
+		p->findChild<QLabel *>()->setText(popupText());
+		p->setProperty("owner", QVariant::fromValue((void *)this));
+		p->adjustSize();
+
 		int l = (int)top->pixelPoint().x();
-		int t = (int)top->pixelPoint().y() - m_popup->height() - 8;
-		int r = l + m_popup->width();
+		int t = (int)top->pixelPoint().y() - p->height() - 8;
+		int r = l + p->width();
 
 		if (r > parentPlot()->contentsRect().right() - parentPlot()->marginRight())
 			l -= (r - parentPlot()->contentsRect().right() + parentPlot()->marginRight());
 
-		m_popup->move(parentPlot()->mapToGlobal(QPoint(l, t)));
-		m_popup->show();
+		p->move(parentPlot()->mapToGlobal(QPoint(l, t)));
+		p->show();
 	}
 	else
 	{
-		m_popup->hide();
+		// Another Item may already have taken over the Popup
+		QFrame * p = parentPlot()->findChild<QFrame *>("AlarmPopup");
+		if (p && (p->property("owner").value<void *>() == this))
+			p->hide();
+	}
+}
+
+QFrame * AlarmPlotItem::popup(QCustomPlot * plot)
+{
+	QFrame * p = plot->findChild<QFrame *>("AlarmPopup");
+	if (p)
+		return p;
+
+	QLabel * lbl = new QLabel;
+	lbl->setTextFormat(Qt::RichText);
+
+	QVBoxLayout * vbox = new QVBoxLayout;
+	vbox->addWidget(lbl);
+
+	p = new QFrame(plot, Qt::ToolTip);
+	p->setObjectName("AlarmPopup");
+	p->setFrameStyle(QFrame::StyledPanel | QFrame::Sunken);
+	p->setLayout(vbox);
+
+	return p;
+}
+
+QString AlarmPlotItem::popupText() const
+{
+	QString text("<table>");
+
+	QMap<unsigned int, QStringList>::const_iterator it;
+	for (it = m_names.begin(); it != m_names.end(); it++)
+	{
+		QStringList names;
+		QStringList::const_iterator itn;
+		for (itn = it->begin(); itn != it->end(); itn++)
+			names << Qt::escape(* itn);
+
+		text += QString("<tr><td>%1</td><td><b>%2</b></td></tr>")
+			.arg(tr("At %1:%2").arg(it.key() / 60).arg(it.key() % 60, 2, 10, QChar('0')))
+			.arg(names.join("<br>"));
 	}
+
+	text += "</table>";
+	return text;
 }
 
 unsigned int AlarmPlotItem::start_time() const
@@ -30,6 +30,7 @@
  */
 
 #include <QFrame>
+#include <QLabel>
 #include <QWidget>
 
 #include <util/qcustomplot.h>
@@ -37,9 +38,10 @@
 /**
  * @brief Alarm Indicator Plot Item
  *
- * QCustomPlot item which represents one or more dive computer alarms during
- * the dive.  The plot item renders a pixmap, and when selected, shows a popup
- * window containing the alarm details.
+ * Shows a warning icon for a group of alarms.  Selecting the item shows a
+ * popup listing the alarms in the group.  A single popup is shared by all
+ * alarm items on a plot and is only created when an item is first selected,
+ * so profiles with many alarms do not create any widgets up front.
  */
 class AlarmPlotItem: public QCPItemPixmap
 {
@@ -64,22 +66,25 @@ public:
 	//! @return End Time
 	unsigned int end_time() const;
 
-	//! @brief Finalize the Alarm Data
-	void finalize();
-
 	//! @return Start Time
 	unsigned int start_time() const;
 
 protected slots:
 	void onSelectionChanged(bool);
 
+private:
+
+	//! @return Shared Popup for a Plot, created on first use
+	static QFrame * popup(QCustomPlot * plot);
+
+	//! @return Popup Text for the Alarm Group
+	QString popupText() const;
+
 private:
 	QMap<unsigned int, QStringList>		m_names;
 	unsigned int						m_tstart;
 	unsigned int						m_tend;
 
-	QFrame *							m_popup;
-
 };
 
 #endif /* PROFILE_ALARMITEM_HPP_ */
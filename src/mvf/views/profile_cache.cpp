@@ -0,0 +1,409 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QSettings>
+
+#include <boost/bind.hpp>
+
+#include "util/formatcache.hpp"
+
+#include "profile_cache.hpp"
+#include "profile_plot.hpp"
+
+//! Maximum Number of Profiles held by the Dive Profile List Cache
+#define PROFILE_LIST_MAX	128
+
+ProfilePlotData::ProfilePlotData(int64_t id, ProfileSeries::Ptr series)
+	: m_id(id), m_series(series), m_channels(), m_alarms()
+{
+}
+
+ProfilePlotData::~ProfilePlotData()
+{
+}
+
+const std::vector<alarm_group_t> & ProfilePlotData::alarms() const
+{
+	return m_alarms;
+}
+
+ProfilePlotData::Ptr ProfilePlotData::Build(Profile::Ptr profile)
+{
+	ProfileSeries::Ptr series = ProfileSeries::Build(profile);
+	if (! series)
+		return Ptr();
+
+	Ptr p(new ProfilePlotData(profile->id(), series));
+	const std::vector<double> & t = series->time();
+
+	/*
+	 * Convert each Channel to the Display Units
+	 */
+	std::set<std::string> keys(series->keys());
+	std::set<std::string>::const_iterator it;
+	for (it = keys.begin(); it != keys.end(); it++)
+	{
+		const std::vector<double> & v = series->channel(* it);
+		const std::vector<uint8_t> & m = series->mask(* it);
+
+		channel_t & c = p->m_channels[* it];
+		c.hasUnit = false;
+
+		quantity_t q = ProfilePlotView::profileKeyQuantity(* it);
+		if (q != qtUnknown)
+		{
+			try
+			{
+				c.unit = FormatCache::Instance()->unit(q);
+				c.hasUnit = (c.unit.conv != 0);
+			}
+			catch (std::runtime_error & e)
+			{
+			}
+		}
+
+		c.time.reserve(t.size());
+		c.values.reserve(t.size());
+
+		for (size_t i = 0; i < t.size(); ++i)
+		{
+			if (! m[i])
+				continue;
+
+			c.time.push_back(t[i] / 60.0f);
+
+			if (! c.hasUnit)
+				c.values.push_back(v[i]);
+			else
+				c.values.push_back(c.unit.conv->fromNative(v[i]));
+		}
+
+		c.lod.reset(new ProfileLOD(c.time, c.values));
+	}
+
+	/*
+	 * Group Alarms within the same 60 seconds
+	 */
+	unsigned int lastAlarm = 0;
+	std::vector<alarm_event_t>::const_iterator ait;
+	for (ait = series->alarms().begin(); ait != series->alarms().end(); ait++)
+	{
+		if (((ait->time - lastAlarm) > 60) || p->m_alarms.empty())
+		{
+			p->m_alarms.push_back(alarm_group_t());
+			lastAlarm = ait->time;
+		}
+
+		p->m_alarms.back().times.push_back(ait->time);
+		p->m_alarms.back().names.push_back(ait->name);
+	}
+
+	return p;
+}
+
+const ProfilePlotData::channel_t & ProfilePlotData::channel(const std::string & key) const
+{
+	return m_channels.at(key);
+}
+
+bool ProfilePlotData::hasChannel(const std::string & key) const
+{
+	return (m_channels.find(key) != m_channels.end());
+}
+
+size_t ProfilePlotData::memoryUsage() const
+{
+	size_t n = m_series->memoryUsage();
+
+	std::map<std::string, channel_t>::const_iterator it;
+	for (it = m_channels.begin(); it != m_channels.end(); it++)
+	{
+		n += (it->second.time.capacity() + it->second.values.capacity()) * sizeof(double) + sizeof(channel_t);
+		n += it->second.lod->memoryUsage();
+	}
+
+	std::vector<alarm_group_t>::const_iterator ait;
+	for (ait = m_alarms.begin(); ait != m_alarms.end(); ait++)
+		n += ait->times.capacity() * sizeof(unsigned int) + ait->names.capacity() * sizeof(std::string);
+
+	return n + sizeof(ProfilePlotData);
+}
+
+int ProfilePlotData::nearestSample(const std::string & key, double time) const
+{
+	const QVector<double> & t = m_channels.at(key).time;
+	if (t.isEmpty())
+		return -1;
+
+	int i = std::lower_bound(t.begin(), t.end(), time) - t.begin();
+	if (i == t.size())
+		return i - 1;
+	if ((i > 0) && (time - t[i - 1] < t[i] - time))
+		return i - 1;
+
+	return i;
+}
+
+int64_t ProfilePlotData::profileId() const
+{
+	return m_id;
+}
+
+ProfileSeries::Ptr ProfilePlotData::series() const
+{
+	return m_series;
+}
+
+ProfileCache * ProfileCache::m_instance = 0;
+
+ProfileCache::ProfileCache(QObject * parent)
+	: QObject(parent), m_mutex(), m_data(), m_profiles(), m_hits(0), m_misses(0), m_session(0)
+{
+	QSettings s;
+	s.beginGroup("Settings");
+	int mb = s.value(QString("ProfileCacheSize"), 32).toInt();
+	s.endGroup();
+
+	m_data.setMaxCost((mb > 0 ? mb : 32) * 1024);
+	m_profiles.setMaxCost(PROFILE_LIST_MAX);
+
+	// Cached Data is in Display Units
+	connect(FormatCache::Instance(), SIGNAL(invalidated()), this, SLOT(clear()));
+}
+
+ProfileCache::~ProfileCache()
+{
+	if (m_evtInserted.connected())
+		m_evtInserted.disconnect();
+	if (m_evtUpdated.connected())
+		m_evtUpdated.disconnect();
+	if (m_evtDeleted.connected())
+		m_evtDeleted.disconnect();
+
+	if (m_instance == this)
+		m_instance = 0;
+}
+
+ProfileCache * ProfileCache::Instance()
+{
+	/*
+	 * NB: The instance should be created from the GUI thread (see main())
+	 * before any worker threads are started.
+	 */
+	if (! m_instance)
+		m_instance = new ProfileCache(QCoreApplication::instance());
+
+	return m_instance;
+}
+
+void ProfileCache::attach(Session::Ptr session)
+{
+	if (! session || (session.get() == m_session))
+		return;
+
+	if (m_evtInserted.connected())
+		m_evtInserted.disconnect();
+	if (m_evtUpdated.connected())
+		m_evtUpdated.disconnect();
+	if (m_evtDeleted.connected())
+		m_evtDeleted.disconnect();
+
+	// Profile identifiers are only unique within a Session
+	clear();
+
+	m_session = session.get();
+	m_evtInserted = session->mapper<Profile>()->events().after_insert.connect(boost::bind(& ProfileCache::profileChanged, this, _1, _2));
+	m_evtUpdated = session->mapper<Profile>()->events().after_update.connect(boost::bind(& ProfileCache::profileChanged, this, _1, _2));
+	m_evtDeleted = session->mapper<Profile>()->events().before_delete.connect(boost::bind(& ProfileCache::profileChanged, this, _1, _2));
+}
+
+void ProfileCache::clear()
+{
+	QMutexLocker lock(& m_mutex);
+	m_data.clear();
+	m_profiles.clear();
+}
+
+ProfilePlotData::Ptr ProfileCache::data(Profile::Ptr profile)
+{
+	if (! profile)
+		return ProfilePlotData::Ptr();
+
+	bool hit;
+	ProfilePlotData::Ptr p = fetch(profile, hit);
+
+	QMutexLocker lock(& m_mutex);
+	if (hit)
+		++m_hits;
+	else
+		++m_misses;
+
+	return p;
+}
+
+ProfilePlotData::Ptr ProfileCache::fetch(Profile::Ptr profile, bool & hit)
+{
+	ProfilePlotData::Ptr p = lookup(profile->id());
+	hit = (bool)p;
+	if (p)
+		return p;
+
+	p = ProfilePlotData::Build(profile);
+	if (! p)
+		return p;
+
+	int cost = (int)((p->memoryUsage() + 1023) / 1024);
+
+	QMutexLocker lock(& m_mutex);
+	m_data.insert(profile->id(), new ProfilePlotData::Ptr(p), cost);
+
+	return p;
+}
+
+unsigned long ProfileCache::hits() const
+{
+	QMutexLocker lock(& m_mutex);
+	return m_hits;
+}
+
+void ProfileCache::invalidate(Dive::Ptr dive)
+{
+	if (! dive)
+		return;
+
+	QMutexLocker lock(& m_mutex);
+	std::vector<Profile::Ptr> * pl = m_profiles.object(dive->id());
+	if (! pl)
+		return;
+
+	std::vector<Profile::Ptr>::const_iterator it;
+	for (it = pl->begin(); it != pl->end(); it++)
+		m_data.remove((* it)->id());
+
+	m_profiles.remove(dive->id());
+}
+
+void ProfileCache::invalidate(Profile::Ptr profile)
+{
+	if (! profile)
+		return;
+
+	remove(profile->id(), profile->dive() ? profile->dive()->id() : -1);
+}
+
+ProfilePlotData::Ptr ProfileCache::lookup(int64_t id) const
+{
+	QMutexLocker lock(& m_mutex);
+	ProfilePlotData::Ptr * p = m_data.object(id);
+	if (! p)
+		return ProfilePlotData::Ptr();
+
+	return * p;
+}
+
+unsigned long ProfileCache::misses() const
+{
+	QMutexLocker lock(& m_mutex);
+	return m_misses;
+}
+
+int ProfileCache::maxCost() const
+{
+	QMutexLocker lock(& m_mutex);
+	return m_data.maxCost();
+}
+
+void ProfileCache::prefetch(Profile::Ptr profile)
+{
+	if (! profile)
+		return;
+
+	bool hit;
+	fetch(profile, hit);
+}
+
+void ProfileCache::profileChanged(AbstractMapper::Ptr, Persistent::Ptr obj)
+{
+	Profile::Ptr p = boost::dynamic_pointer_cast<Profile>(obj);
+	if (! p)
+		return;
+
+	invalidate(p);
+}
+
+std::vector<Profile::Ptr> ProfileCache::profiles(Dive::Ptr dive, bool store)
+{
+	if (! dive)
+		return std::vector<Profile::Ptr>();
+
+	attach(dive->session());
+
+	{
+		QMutexLocker lock(& m_mutex);
+		std::vector<Profile::Ptr> * cached = m_profiles.object(dive->id());
+		if (cached)
+			return * cached;
+	}
+
+	//TODO: Use Dive::Profiles collection
+	IProfileFinder::Ptr pf = boost::dynamic_pointer_cast<IProfileFinder>(dive->session()->finder<Profile>());
+	std::vector<Profile::Ptr> pl = pf->findByDive(dive->id());
+	if (! store)
+		return pl;
+
+	QMutexLocker lock(& m_mutex);
+	m_profiles.insert(dive->id(), new std::vector<Profile::Ptr>(pl), std::max<int>(pl.size(), 1));
+
+	return pl;
+}
+
+void ProfileCache::remove(int64_t profile_id, int64_t dive_id)
+{
+	QMutexLocker lock(& m_mutex);
+	m_data.remove(profile_id);
+	m_profiles.remove(dive_id);
+}
+
+void ProfileCache::resetStatistics()
+{
+	QMutexLocker lock(& m_mutex);
+	m_hits = 0;
+	m_misses = 0;
+}
+
+void ProfileCache::setMaxCost(int value)
+{
+	QMutexLocker lock(& m_mutex);
+	m_data.setMaxCost(value);
+}
+
+int ProfileCache::totalCost() const
+{
+	QMutexLocker lock(& m_mutex);
+	return m_data.totalCost();
+}
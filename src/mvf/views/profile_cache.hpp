@@ -0,0 +1,316 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef PROFILE_CACHE_HPP_
+#define PROFILE_CACHE_HPP_
+
+/**
+ * @file src/mvf/views/profile_cache.hpp
+ * @brief Decoded Profile Cache
+ * @author Jonathan Krauss <jkrauss@asymworks.com>
+ */
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <QCache>
+#include <QMutex>
+#include <QObject>
+#include <QVector>
+
+#include <boost/shared_ptr.hpp>
+#include <boost/signals2.hpp>
+
+#include <util/profilelod.hpp>
+#include <util/profileseries.hpp>
+#include <util/units.hpp>
+
+/*
+ * FIX for broken Qt4 moc and BOOST_JOIN error
+ */
+#ifdef Q_MOC_RUN
+#define BOOST_NO_TEMPLATE_PARTIAL_SPECIALIZATION
+#endif
+
+#include <benthos/logbook/dive.hpp>
+#include <benthos/logbook/mapper.hpp>
+#include <benthos/logbook/persistent.hpp>
+#include <benthos/logbook/profile.hpp>
+#include <benthos/logbook/session.hpp>
+using namespace benthos::logbook;
+
+/**
+ * @brief Group of Alarms shown as a single Plot Item
+ *
+ * Alarms which occur within 60 seconds of the first alarm in the group are
+ * collected into one group so that they are displayed as a single icon.
+ */
+typedef struct
+{
+	std::vector<unsigned int>	times;
+	std::vector<std::string>	names;
+} alarm_group_t;
+
+/**
+ * @brief Plot-Ready Profile Data
+ *
+ * Holds the decoded profile series along with each data channel converted to
+ * the current display units and laid out as the (time, value) vectors which
+ * are passed directly to QCustomPlot.  Time values are in minutes.  Samples
+ * which are not present in a channel are omitted from its vectors.  Each
+ * channel also carries a level-of-detail pyramid which the plot uses to
+ * decimate the data to the visible range and plot width.
+ *
+ * Instances are immutable once built and are shared between the cache and
+ * any views displaying them.
+ */
+class ProfilePlotData
+{
+public:
+	typedef boost::shared_ptr<ProfilePlotData>	Ptr;
+
+	//! Converted Channel Data
+	typedef struct
+	{
+		QVector<double>		time;
+		QVector<double>		values;
+		unit_t				unit;
+		bool				hasUnit;
+		ProfileLOD::Ptr		lod;
+	} channel_t;
+
+public:
+
+	//! Class Destructor
+	~ProfilePlotData();
+
+	/**
+	 * @brief Build the Plot Data for a Profile
+	 * @param[in] Profile
+	 * @return Plot Data, or an empty pointer if the profile is empty
+	 */
+	static Ptr Build(Profile::Ptr profile);
+
+public:
+
+	//! @return Alarm Groups
+	const std::vector<alarm_group_t> & alarms() const;
+
+	/**
+	 * @brief Get the Converted Data for a Channel
+	 * @param[in] Channel Key
+	 * @return Channel Data
+	 * @throws std::out_of_range if the channel does not exist
+	 */
+	const channel_t & channel(const std::string & key) const;
+
+	//! @return If the Data has the given Channel
+	bool hasChannel(const std::string & key) const;
+
+	//! @return Approximate Memory Footprint in Bytes
+	size_t memoryUsage() const;
+
+	/**
+	 * @brief Find the Sample of a Channel nearest to a Time
+	 * @param[in] Channel Key
+	 * @param[in] Time in Minutes
+	 * @return Index into the Channel Vectors, or -1 if the channel is empty
+	 * @throws std::out_of_range if the channel does not exist
+	 *
+	 * Uses a binary search over the channel's time vector.
+	 */
+	int nearestSample(const std::string & key, double time) const;
+
+	//! @return Profile Identifier
+	int64_t profileId() const;
+
+	//! @return Decoded Profile Series
+	ProfileSeries::Ptr series() const;
+
+protected:
+
+	//! Class Constructor
+	ProfilePlotData(int64_t id, ProfileSeries::Ptr series);
+
+private:
+	int64_t								m_id;
+	ProfileSeries::Ptr					m_series;
+	std::map<std::string, channel_t>	m_channels;
+	std::vector<alarm_group_t>			m_alarms;
+
+};
+
+/**
+ * @brief Decoded Profile Cache
+ *
+ * LRU cache of ProfilePlotData keyed by profile id, so that switching back
+ * to a recently viewed dive does not re-query and re-decode its profiles.
+ * The cache cost is the approximate memory footprint of each entry and the
+ * budget is read from the Settings/ProfileCacheSize setting (in megabytes).
+ * The list of profiles belonging to each recently used dive is cached as
+ * well so that the IProfileFinder query is skipped on a hit.  That cache is
+ * bounded by the number of Profile instances it holds, since each one keeps
+ * its waypoints and raw data in memory.
+ *
+ * Entries are invalidated when a Profile is updated or deleted through the
+ * logbook session, when invalidate() is called after a merge or transfer, and
+ * when the display units change (FormatCache::invalidated()).
+ *
+ * The cache counts hits and misses for data() requests so that the
+ * effectiveness of prefetching can be measured; prefetch() requests are not
+ * counted.
+ *
+ * The cache itself is guarded by a lock and profiles are decoded without it
+ * held, so data(), lookup(), prefetch() and the statistics methods may be
+ * called from worker threads.  Methods which query the logbook session are
+ * marked as GUI-thread only, since the session is not thread-safe.
+ */
+class ProfileCache: public QObject
+{
+	Q_OBJECT
+
+public:
+
+	//! @return Global Profile Cache Instance
+	static ProfileCache * Instance();
+
+	//! Class Destructor
+	virtual ~ProfileCache();
+
+public:
+
+	/**
+	 * @brief Get the Plot Data for a Profile
+	 * @param[in] Profile
+	 * @return Plot Data, or an empty pointer if the profile is empty
+	 *
+	 * Decodes the profile and stores it in the cache if it is not already
+	 * cached.  Thread-safe.
+	 */
+	ProfilePlotData::Ptr data(Profile::Ptr profile);
+
+	/**
+	 * @brief Look up cached Plot Data for a Profile
+	 * @param[in] Profile Identifier
+	 * @return Plot Data, or an empty pointer if the profile is not cached
+	 *
+	 * Thread-safe.
+	 */
+	ProfilePlotData::Ptr lookup(int64_t id) const;
+
+	/**
+	 * @brief Load a Profile into the Cache
+	 * @param[in] Profile
+	 *
+	 * Same as data() but does not update the hit/miss counters.  Used by the
+	 * background prefetcher.  Thread-safe.
+	 */
+	void prefetch(Profile::Ptr profile);
+
+	/**
+	 * @brief Get the Profiles belonging to a Dive
+	 * @param[in] Dive
+	 * @param[in] Store the List in the Cache
+	 * @return List of Profiles
+	 *
+	 * Queries the logbook session, so must be called from the GUI thread.
+	 * Pass false for the second argument to use a cached list if there is
+	 * one without caching a newly queried one.
+	 */
+	std::vector<Profile::Ptr> profiles(Dive::Ptr dive, bool store = true);
+
+	/**
+	 * @brief Invalidate all cached Data for a Dive
+	 * @param[in] Dive
+	 *
+	 * Thread-safe.
+	 */
+	void invalidate(Dive::Ptr dive);
+
+	/**
+	 * @brief Invalidate cached Data for a Profile
+	 * @param[in] Profile
+	 *
+	 * Loads the profile's dive from the logbook session if it is not already
+	 * loaded, so must be called from the GUI thread.
+	 */
+	void invalidate(Profile::Ptr profile);
+
+	//! @return Number of data() Requests served from the Cache
+	unsigned long hits() const;
+
+	//! @return Number of data() Requests which had to Decode the Profile
+	unsigned long misses() const;
+
+	//! @brief Reset the Hit/Miss Counters
+	void resetStatistics();
+
+	//! @return Memory Budget in Kilobytes
+	int maxCost() const;
+
+	//! @param[in] Memory Budget in Kilobytes
+	void setMaxCost(int value);
+
+	//! @return Total Cost of cached Data in Kilobytes
+	int totalCost() const;
+
+public slots:
+
+	//! @brief Clear all cached Data
+	void clear();
+
+protected:
+
+	//! Class Constructor
+	ProfileCache(QObject * parent = 0);
+
+	//! Attach to the Session's Profile Mapper Events (GUI thread only)
+	void attach(Session::Ptr session);
+
+	//! Look up or Decode a Profile
+	ProfilePlotData::Ptr fetch(Profile::Ptr profile, bool & hit);
+
+	//! Remove a Profile and its Dive's Profile List from the Cache
+	void remove(int64_t profile_id, int64_t dive_id);
+
+	//! Profile Mapper Event Handler
+	void profileChanged(AbstractMapper::Ptr, Persistent::Ptr);
+
+private:
+	mutable QMutex										m_mutex;
+	QCache<int64_t, ProfilePlotData::Ptr>				m_data;
+	QCache<int64_t, std::vector<Profile::Ptr> >			m_profiles;
+	unsigned long										m_hits;
+	unsigned long										m_misses;
+
+	Session *											m_session;
+	boost::signals2::connection							m_evtInserted;
+	boost::signals2::connection							m_evtUpdated;
+	boost::signals2::connection							m_evtDeleted;
+
+	static ProfileCache *								m_instance;
+
+};
+
+#endif /* PROFILE_CACHE_HPP_ */
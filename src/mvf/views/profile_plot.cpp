@@ -20,40 +20,105 @@
  * 02110-1301, USA.
  */
 
+#include <QElapsedTimer>
+#include <QEvent>
 #include <QHBoxLayout>
+#include <QMouseEvent>
+#include <QResizeEvent>
 #include <QSettings>
 #include <QVBoxLayout>
+#include <QWheelEvent>
 
 #include <boost/locale.hpp>
 
 #include <benthos/logbook/logging.hpp>
 #include <benthos/logbook/session.hpp>
 
+#include "util/formatcache.hpp"
+#include "workers/plotrenderworker.hpp"
+
 #include "profile_alarmitem.hpp"
 #include "profile_plot.hpp"
 
+//! Narrowest Time Range (in minutes) which can be zoomed to
+#define PLOT_MIN_TIME_SPAN	1.0
+
 ProfilePlotView::ProfilePlotView(QWidget * parent)
 	: QWidget(parent), m_lblProfile(0), m_cbxProfile(0), m_cbxAuxKeys(0),
-	  m_pltDepth(0), m_pltAux(0), m_curDive(), m_curProfile(), m_auxKey()
+	  m_pltDepth(0), m_pltAux(0), m_curDive(), m_curProfile(), m_curData(), m_profiles(),
+	  m_auxKey(), m_auxShown(), m_tmrReplot(), m_plotLayout(), m_depthImage(0), m_renderPool(0),
+	  m_renderGen(0), m_timeExtent(), m_tmrInteract(0), m_dragging(false), m_interacting(false),
+	  m_syncingRange(false), m_xhDepth(0), m_xhAux(0), m_xhText(0), m_xhKeys(), m_xhShown(false)
 {
+	m_renderPool = new QThreadPool(this);
+	m_renderPool->setMaxThreadCount(1);
+
+	// Wheel Zooming ends when no Wheel Events arrive for this long
+	m_tmrInteract = new QTimer(this);
+	m_tmrInteract->setInterval(250);
+	m_tmrInteract->setSingleShot(true);
+	connect(m_tmrInteract, SIGNAL(timeout()), this, SLOT(onInteractTimer()));
+
 	createLayout();
 
-	QVariant vkey;
 	QSettings s;
 	s.beginGroup("ProfileView");
-	vkey = s.value("AuxKey");
+	m_auxKey = s.value("AuxKey").toString();
 	s.endGroup();
-
-	if (vkey.isValid())
-		setAuxKey(vkey.toString());
 }
 
 ProfilePlotView::~ProfilePlotView()
 {
+	// Cancel any pending Render before the Generation Counter is destroyed
+	m_renderGen.ref();
+	m_renderPool->waitForDone();
 }
 
 QString ProfilePlotView::alarmLabel(const std::string & name)
 {
+	return FormatCache::Instance()->format("alarm", QString::fromStdString(name), & formatAlarmLabel);
+}
+
+Profile::Ptr ProfilePlotView::defaultProfile(Dive::Ptr dive, const std::vector<Profile::Ptr> & profiles)
+{
+	if (profiles.empty())
+		return Profile::Ptr();
+
+	if (dive)
+	{
+		std::vector<Profile::Ptr>::const_iterator it;
+		for (it = profiles.begin(); it != profiles.end(); it++)
+			if ((* it)->computer() == dive->computer())
+				return * it;
+	}
+
+	return profiles.front();
+}
+
+void ProfilePlotView::beginInteraction()
+{
+	if (m_interacting)
+		return;
+
+	m_interacting = true;
+
+	// Cancel any in-flight Render; the Graph is drawn directly until the end
+	m_renderGen.ref();
+
+	m_pltDepth->setNotAntialiasedElements(QCP::aeAll);
+	m_pltAux->setNotAntialiasedElements(QCP::aeAll);
+
+	if (m_depthImage)
+	{
+		updateGraphData(m_pltDepth, "depth", false);
+		m_pltDepth->graph(0)->setVisible(true);
+		m_depthImage->setVisible(false);
+	}
+}
+
+QString ProfilePlotView::formatAlarmLabel(const QVariant & value)
+{
+	std::string name(value.toString().toStdString());
 	std::string lname(name);
 	std::transform(lname.begin(), lname.end(), lname.begin(), tolower);
 
@@ -67,28 +132,50 @@ QString ProfilePlotView::alarmLabel(const std::string & name)
 	return QString::fromStdString(boost::locale::to_title(name2));
 }
 
-void ProfilePlotView::cbxAuxKeysIndexChanged(int index)
+void ProfilePlotView::cbxAuxKeysActivated(int index)
 {
 	setAuxKey(m_cbxAuxKeys->itemData(index, Qt::UserRole).toString());
 }
 
-void ProfilePlotView::cbxProfileIndexChanged(int index)
+void ProfilePlotView::cbxProfileActivated(int index)
 {
-	if (! m_curDive)
-		return;
-
-	bool ok;
-	int pid = m_cbxProfile->itemData(index, Qt::UserRole).toInt(& ok);
-
-	if (ok)
-	{
-		IProfileFinder::Ptr pf = boost::dynamic_pointer_cast<IProfileFinder>(m_curDive->session()->finder<Profile>());
-		setProfile(pf->find(pid));
-	}
-	else
-	{
+	if ((index < 0) || (index >= (int)m_profiles.size()))
 		setProfile(Profile::Ptr());
-	}
+	else
+		setProfile(m_profiles[index]);
+}
+
+void ProfilePlotView::createCrosshair()
+{
+	QPen pen(QColor(64, 64, 64, 160));
+	pen.setStyle(Qt::DashLine);
+
+	m_xhDepth = new QCPItemStraightLine(m_pltDepth);
+	m_xhDepth->setLayer("overlay");
+	m_xhDepth->setPen(pen);
+	m_xhDepth->setSelectable(false);
+	m_xhDepth->setVisible(false);
+	m_pltDepth->addItem(m_xhDepth);
+
+	m_xhAux = new QCPItemStraightLine(m_pltAux);
+	m_xhAux->setLayer("overlay");
+	m_xhAux->setPen(pen);
+	m_xhAux->setSelectable(false);
+	m_xhAux->setVisible(false);
+	m_pltAux->addItem(m_xhAux);
+
+	m_xhText = new QCPItemText(m_pltDepth);
+	m_xhText->setLayer("overlay");
+	m_xhText->setBrush(QColor(255, 255, 255, 224));
+	m_xhText->setPen(QColor(192, 192, 192, 255));
+	m_xhText->setPadding(QMargins(4, 2, 4, 2));
+	m_xhText->setTextAlignment(Qt::AlignLeft);
+	m_xhText->position->setType(QCPItemPosition::ptAbsolute);
+	m_xhText->setSelectable(false);
+	m_xhText->setVisible(false);
+	m_pltDepth->addItem(m_xhText);
+
+	m_xhShown = false;
 }
 
 void ProfilePlotView::createLayout()
@@ -139,7 +226,37 @@ void ProfilePlotView::createLayout()
 	m_pltDepth->yAxis2->setTickPen(Qt::NoPen);
 	m_pltDepth->yAxis2->setVisible(true);
 
+	/*
+	 * Cache the Static Layers (grid, graph, axes) and draw Alarms on top
+	 */
+	m_pltDepth->addLayer("overlay", m_pltDepth->layer("axes"), QCustomPlot::limAbove);
+	m_pltDepth->setCachedLayer(m_pltDepth->layer("axes"));
+
 	connect(m_pltDepth, SIGNAL(beforeReplot()), this, SLOT(pltDepthBeforeReplot()));
+#ifdef BENTHOS_PLOT_TIMING
+	connect(m_pltDepth, SIGNAL(afterReplot()), this, SLOT(pltDepthAfterReplot()));
+#endif
+
+	/*
+	 * Track the Mouse for the Crosshair
+	 */
+	m_pltDepth->setMouseTracking(true);
+	m_pltDepth->installEventFilter(this);
+
+	/*
+	 * Zoom and Pan the Time Axis only
+	 */
+	m_pltDepth->setInteraction(QCustomPlot::iRangeDrag, true);
+	m_pltDepth->setInteraction(QCustomPlot::iRangeZoom, true);
+	m_pltDepth->setRangeDrag(Qt::Horizontal);
+	m_pltDepth->setRangeZoom(Qt::Horizontal);
+
+	connect(m_pltDepth->xAxis, SIGNAL(rangeChanged(const QCPRange &)), this, SLOT(pltDepthRangeChanged(const QCPRange &)));
+	connect(m_pltDepth, SIGNAL(mouseDoubleClick(QMouseEvent *)), this, SLOT(pltMouseDoubleClick(QMouseEvent *)));
+	connect(m_pltDepth, SIGNAL(mouseMove(QMouseEvent *)), this, SLOT(pltMouseMove(QMouseEvent *)));
+	connect(m_pltDepth, SIGNAL(mousePress(QMouseEvent *)), this, SLOT(pltMousePress(QMouseEvent *)));
+	connect(m_pltDepth, SIGNAL(mouseRelease(QMouseEvent *)), this, SLOT(pltMouseRelease(QMouseEvent *)));
+	connect(m_pltDepth, SIGNAL(mouseWheel(QWheelEvent *)), this, SLOT(pltMouseWheel(QWheelEvent *)));
 
 	/*
 	 * Setup Aux Plot Margins
@@ -148,6 +265,23 @@ void ProfilePlotView::createLayout()
 	m_pltAux->setAutoMargin(false);
 	m_pltAux->setMinimumSize(400, 80);
 	m_pltAux->setMargin(lMargin, 8, 8, 8);
+	m_pltAux->addLayer("overlay", m_pltAux->layer("axes"), QCustomPlot::limAbove);
+	m_pltAux->setCachedLayer(m_pltAux->layer("axes"));
+
+	m_pltAux->setMouseTracking(true);
+	m_pltAux->installEventFilter(this);
+
+	m_pltAux->setInteraction(QCustomPlot::iRangeDrag, true);
+	m_pltAux->setInteraction(QCustomPlot::iRangeZoom, true);
+	m_pltAux->setRangeDrag(Qt::Horizontal);
+	m_pltAux->setRangeZoom(Qt::Horizontal);
+
+	connect(m_pltAux->xAxis, SIGNAL(rangeChanged(const QCPRange &)), this, SLOT(pltAuxRangeChanged(const QCPRange &)));
+	connect(m_pltAux, SIGNAL(mouseDoubleClick(QMouseEvent *)), this, SLOT(pltMouseDoubleClick(QMouseEvent *)));
+	connect(m_pltAux, SIGNAL(mouseMove(QMouseEvent *)), this, SLOT(pltMouseMove(QMouseEvent *)));
+	connect(m_pltAux, SIGNAL(mousePress(QMouseEvent *)), this, SLOT(pltMousePress(QMouseEvent *)));
+	connect(m_pltAux, SIGNAL(mouseRelease(QMouseEvent *)), this, SLOT(pltMouseRelease(QMouseEvent *)));
+	connect(m_pltAux, SIGNAL(mouseWheel(QWheelEvent *)), this, SLOT(pltMouseWheel(QWheelEvent *)));
 
 	/*
 	 * Setup Aux Plot Axes
@@ -187,8 +321,8 @@ void ProfilePlotView::createLayout()
 	m_lblProfile->setVisible(false);
 	m_cbxProfile->setVisible(false);
 
-	connect(m_cbxAuxKeys, SIGNAL(currentIndexChanged(int)), this, SLOT(cbxAuxKeysIndexChanged(int)));
-	connect(m_cbxProfile, SIGNAL(currentIndexChanged(int)), this, SLOT(cbxProfileIndexChanged(int)));
+	connect(m_cbxAuxKeys, SIGNAL(activated(int)), this, SLOT(cbxAuxKeysActivated(int)));
+	connect(m_cbxProfile, SIGNAL(activated(int)), this, SLOT(cbxProfileActivated(int)));
 
 	/*
 	 * Setup Layout
@@ -212,83 +346,186 @@ void ProfilePlotView::createLayout()
 	setLayout(vbox);
 }
 
+void ProfilePlotView::endInteraction()
+{
+	if (! m_interacting)
+		return;
+
+	m_interacting = false;
+
+	m_pltDepth->setNotAntialiasedElements(QCP::aeNone);
+	m_pltAux->setNotAntialiasedElements(QCP::aeNone);
+
+	requestDepthRender();
+	m_pltDepth->queueReplot();
+	m_pltAux->queueReplot();
+}
+
+bool ProfilePlotView::eventFilter(QObject * obj, QEvent * event)
+{
+	if (((obj == m_pltDepth) || (obj == m_pltAux)) && (event->type() == QEvent::Leave))
+		hideCrosshair();
+
+	return QWidget::eventFilter(obj, event);
+}
+
+void ProfilePlotView::hideCrosshair()
+{
+	if (! m_xhShown)
+		return;
+
+	m_xhDepth->setVisible(false);
+	m_xhAux->setVisible(false);
+	m_xhText->setVisible(false);
+	m_xhShown = false;
+
+	m_pltDepth->queueReplot();
+	m_pltAux->queueReplot();
+}
+
 void ProfilePlotView::loadAuxPlotData(const std::string & key)
 {
 	/*
 	 * Clear the Existing Plot Data
 	 */
+	m_auxShown.clear();
 	m_pltAux->clearGraphs();
 	m_pltAux->yAxis->setLabel(QString());
 	m_pltAux->yAxis->setTickVector(QVector<double>());
-	m_pltAux->replot();
+	m_pltAux->queueReplot();
 
 	/*
 	 * Check the Key is Valid
 	 */
-	if (! m_curProfile || key.empty())
+	if (! m_curData || key.empty())
 		return;
 
-	if (m_curProfile->keys().find(key) == m_curProfile->keys().end())
+	if (! m_curData->hasChannel(key))
 	{
 		logging::getLogger("gui.plot")->warning("Unknown Profile Data Key: " + key);
 		return;
 	}
 
-	/*
-	 * Load the Value Quantity Type and Units
-	 */
-	unit_t unit;
-	bool hasUnit = false;
-
-	try
-	{
-		quantity_t q = profileKeyQuantity(key);
-		if (q != qtUnknown)
-			unit = unitForQuantity(q);
-
-		hasUnit = true;
-	}
-	catch (std::runtime_error & e)
-	{
-	}
-
-	/*
-	 * Create the Plot Vector
-	 */
-	QVector<double> time;
-	QVector<double> value;
-	std::list<waypoint>::const_iterator it;
-	for (it = m_curProfile->profile().begin(); it != m_curProfile->profile().end(); it++)
-	{
-		time.push_back(it->time / 60.0f);
-
-		if (! hasUnit)
-			value.push_back(it->data.at(key));
-		else
-			value.push_back(unit.conv->fromNative(it->data.at(key)));
-	}
+	const ProfilePlotData::channel_t & c = m_curData->channel(key);
 
 	/*
 	 * Setup the Aux Plot
 	 */
-	if (hasUnit)
-		m_pltAux->yAxis->setLabel(QString::fromStdWString(unit.abbr));
+	if (c.hasUnit)
+		m_pltAux->yAxis->setLabel(QString::fromStdWString(c.unit.abbr));
 
 	m_pltAux->addGraph();
 	m_pltAux->graph(0)->setPen(QColor(64, 64, 64, 255));
-	m_pltAux->graph(0)->setData(time, value);
+	m_auxShown = key;
+	updateGraphData(m_pltAux, key, true);
 	m_pltAux->graph(0)->rescaleAxes();
 	setupAuxAxis();
-	m_pltAux->replot();
+	m_pltAux->queueReplot();
+}
+
+void ProfilePlotView::onDepthRendered(int serial, const QImage & image)
+{
+	// Drop Images for superseded Requests
+	if ((serial != (int)m_renderGen) || ! m_depthImage)
+		return;
+
+	m_depthImage->setPixmap(QPixmap::fromImage(image));
+	m_depthImage->setVisible(true);
+	m_pltDepth->graph(0)->setVisible(false);
+	m_pltDepth->queueReplot();
+}
+
+void ProfilePlotView::onInteractTimer()
+{
+	if (! m_dragging)
+		endInteraction();
+}
+
+void ProfilePlotView::pltAuxRangeChanged(const QCPRange & range)
+{
+	setTimeRange(range);
+}
+
+void ProfilePlotView::pltDepthAfterReplot()
+{
+#ifdef BENTHOS_PLOT_TIMING
+	logging::getLogger("gui.plot")->debug("replot: %ld us", (long)(m_tmrReplot.nsecsElapsed() / 1000));
+#endif
 }
 
 void ProfilePlotView::pltDepthBeforeReplot()
 {
+#ifdef BENTHOS_PLOT_TIMING
+	m_tmrReplot.start();
+#endif
+
+	/*
+	 * Only reposition the Alarm Items and re-render the Depth Graph if they
+	 * or the Axes have changed
+	 */
+	QVector<double> layout;
+	QRect r = m_pltDepth->axisRect();
+	layout << r.x() << r.y() << r.width() << r.height();
+	layout << m_pltDepth->xAxis->range().lower << m_pltDepth->xAxis->range().upper;
+	layout << m_pltDepth->yAxis->range().lower << m_pltDepth->yAxis->range().upper;
+
+	if (layout == m_plotLayout)
+		return;
+
+	m_plotLayout = layout;
 	setupAlarms();
+
+	if (! m_interacting)
+		requestDepthRender();
 }
 
-QString ProfilePlotView::profileKeyLabel(const std::string & key)
+void ProfilePlotView::pltDepthRangeChanged(const QCPRange & range)
+{
+	setTimeRange(range);
+}
+
+void ProfilePlotView::pltMouseDoubleClick(QMouseEvent *)
+{
+	setTimeRange(m_timeExtent);
+}
+
+void ProfilePlotView::pltMouseMove(QMouseEvent * e)
+{
+	QCustomPlot * plot = qobject_cast<QCustomPlot *>(sender());
+	if (! plot || ! m_xhText)
+		return;
+
+	QRect r = plot->axisRect();
+	if ((e->pos().x() < r.left()) || (e->pos().x() > r.right()))
+	{
+		hideCrosshair();
+		return;
+	}
+
+	updateCrosshair(plot->xAxis->pixelToCoord(e->pos().x()));
+}
+
+void ProfilePlotView::pltMousePress(QMouseEvent * e)
+{
+	if (e->button() == Qt::LeftButton)
+		m_dragging = true;
+}
+
+void ProfilePlotView::pltMouseRelease(QMouseEvent *)
+{
+	m_dragging = false;
+	if (! m_tmrInteract->isActive())
+		endInteraction();
+}
+
+void ProfilePlotView::pltMouseWheel(QWheelEvent *)
 {
+	m_tmrInteract->start();
+}
+
+QString ProfilePlotView::formatProfileKeyLabel(const QVariant & value)
+{
+	std::string key(value.toString().toStdString());
 	std::string lkey(key);
 	std::transform(lkey.begin(), lkey.end(), lkey.begin(), tolower);
 
@@ -314,6 +551,11 @@ QString ProfilePlotView::profileKeyLabel(const std::string & key)
 	return QString::fromStdString(boost::locale::to_title(key2));
 }
 
+QString ProfilePlotView::profileKeyLabel(const std::string & key)
+{
+	return FormatCache::Instance()->format("profilekey", QString::fromStdString(key), & formatProfileKeyLabel);
+}
+
 quantity_t ProfilePlotView::profileKeyQuantity(const std::string & key)
 {
 	std::string lkey(key);
@@ -363,6 +605,75 @@ QString ProfilePlotView::profileLabel(Profile::Ptr profile)
 	return "Unknown Profile";
 }
 
+void ProfilePlotView::resizeEvent(QResizeEvent * e)
+{
+	QWidget::resizeEvent(e);
+
+	/*
+	 * Re-decimate the Aux Plot Data for the new Width.  The Depth Graph is
+	 * re-rendered when the depth plot sees its new layout.
+	 */
+	if (! m_curData)
+		return;
+
+	if (m_pltAux->graphCount() && ! m_auxShown.empty())
+	{
+		updateGraphData(m_pltAux, m_auxShown, false);
+		m_pltAux->queueReplot();
+	}
+}
+
+void ProfilePlotView::requestDepthRender()
+{
+	if (! m_depthImage || ! m_pltDepth->graphCount())
+		return;
+
+	/*
+	 * Stretch the current Image over the new Axis Rect until the new one
+	 * arrives
+	 */
+	QRect r = m_pltDepth->axisRect();
+	m_depthImage->topLeft->setType(QCPItemPosition::ptAbsolute);
+	m_depthImage->topLeft->setCoords(r.left(), r.top());
+	m_depthImage->bottomRight->setType(QCPItemPosition::ptAbsolute);
+	m_depthImage->bottomRight->setCoords(r.left() + r.width(), r.top() + r.height());
+
+	/*
+	 * Snapshot the Graph.  Gradients stretched to the plot are converted to
+	 * widget coordinates since the worker paints into an image of the axis
+	 * rect only.
+	 */
+	QCPGraph * g = m_pltDepth->graph(0);
+
+	plot_render_t snapshot;
+	snapshot.lod = m_curData->channel("depth").lod;
+	snapshot.axisRect = r;
+	snapshot.xLower = m_pltDepth->xAxis->range().lower;
+	snapshot.xUpper = m_pltDepth->xAxis->range().upper;
+	snapshot.yLower = m_pltDepth->yAxis->range().lower;
+	snapshot.yUpper = m_pltDepth->yAxis->range().upper;
+	snapshot.yReversed = m_pltDepth->yAxis->rangeReversed();
+	snapshot.pen = g->pen();
+	snapshot.brush = g->brush();
+
+	const QGradient * grad = g->brush().gradient();
+	if (grad && (grad->type() == QGradient::LinearGradient) && (grad->coordinateMode() == QGradient::StretchToDeviceMode))
+	{
+		const QLinearGradient * lg = static_cast<const QLinearGradient *>(grad);
+		QLinearGradient wg(lg->start().x() * m_pltDepth->width(), lg->start().y() * m_pltDepth->height(),
+			lg->finalStop().x() * m_pltDepth->width(), lg->finalStop().y() * m_pltDepth->height());
+		wg.setStops(lg->stops());
+		snapshot.brush = QBrush(wg);
+	}
+
+	// Supersede any in-flight Render
+	int serial = m_renderGen.fetchAndAddOrdered(1) + 1;
+
+	PlotRenderWorker * worker = new PlotRenderWorker(snapshot, & m_renderGen, serial);
+	connect(worker, SIGNAL(rendered(int, const QImage &)), this, SLOT(onDepthRendered(int, const QImage &)), Qt::QueuedConnection);
+	m_renderPool->start(worker);
+}
+
 void ProfilePlotView::setAuxKey(const QString & key)
 {
 	m_auxKey = key;
@@ -376,24 +687,25 @@ void ProfilePlotView::setAuxKey(const QString & key)
 }
 
 void ProfilePlotView::setDive(Dive::Ptr dive)
+{
+	std::vector<Profile::Ptr> pl;
+	if (dive)
+		pl = ProfileCache::Instance()->profiles(dive);
+
+	setDive(dive, pl, defaultProfile(dive, pl));
+}
+
+void ProfilePlotView::setDive(Dive::Ptr dive, const std::vector<Profile::Ptr> & profiles, Profile::Ptr profile, ProfilePlotData::Ptr data)
 {
 	m_cbxProfile->clear();
 	m_cbxProfile->setVisible(false);
 	m_lblProfile->setVisible(false);
 
 	m_curDive = dive;
-	if (! m_curDive)
-	{
-		setProfile(Profile::Ptr());
-		return;
-	}
-
-	//TODO: Use Dive::Profiles collection
-	IProfileFinder::Ptr pf = boost::dynamic_pointer_cast<IProfileFinder>(m_curDive->session()->finder<Profile>());
-	std::vector<Profile::Ptr> pl = pf->findByDive(m_curDive->id());
-
-	if (pl.empty())
+	m_profiles = profiles;
+	if (! m_curDive || m_profiles.empty())
 	{
+		m_profiles.clear();
 		setProfile(Profile::Ptr());
 		return;
 	}
@@ -401,26 +713,14 @@ void ProfilePlotView::setDive(Dive::Ptr dive)
 	/*
 	 * Load the list of Profiles
 	 */
-	int defidx = -1;
-	int idx = 0;
-	Profile::Ptr def_p;
-	std::vector<Profile::Ptr>::iterator it;
-	for (it = pl.begin(); it != pl.end(); it++)
+	int defidx = 0;
+	std::vector<Profile::Ptr>::const_iterator it;
+	for (it = m_profiles.begin(); it != m_profiles.end(); it++)
 	{
-		++idx;
-		m_cbxProfile->addItem(profileLabel(* it), QVariant((qlonglong)(* it)->id()));
-
-		if ((* it)->computer() == m_curDive->computer())
-		{
-			defidx = idx;
-			def_p = * it;
-		}
-	}
+		if (* it == profile)
+			defidx = m_cbxProfile->count();
 
-	if (! def_p && (pl.size() == 1))
-	{
-		def_p = * pl.begin();
-		defidx = 0;
+		m_cbxProfile->addItem(profileLabel(* it), QVariant((qlonglong)(* it)->id()));
 	}
 
 	if (m_cbxProfile->count() > 1)
@@ -433,19 +733,33 @@ void ProfilePlotView::setDive(Dive::Ptr dive)
 	 * Load the Profile
 	 */
 	m_cbxProfile->setCurrentIndex(defidx);
-	setProfile(* pl.begin());
+	setProfile(m_profiles[defidx], (m_profiles[defidx] == profile) ? data : ProfilePlotData::Ptr());
 }
 
-void ProfilePlotView::setProfile(Profile::Ptr profile)
+void ProfilePlotView::setProfile(Profile::Ptr profile, ProfilePlotData::Ptr data)
 {
+	// Cancel any in-flight Render of the previous Profile
+	endInteraction();
+	m_renderGen.ref();
+
 	m_pltDepth->clearGraphs();
 	m_pltDepth->clearItems();
+	m_pltAux->clearItems();
+	m_depthImage = 0;
+	m_xhDepth = 0;
+	m_xhAux = 0;
+	m_xhText = 0;
+	m_xhKeys.clear();
+	m_xhShown = false;
+	m_plotLayout.clear();
+	m_pltDepth->queueReplot();
 
 	m_cbxAuxKeys->clear();
 	m_cbxAuxKeys->setEnabled(false);
 
 	m_curProfile = profile;
-	if (! m_curProfile)
+	m_curData = data ? data : ProfileCache::Instance()->data(profile);
+	if (! m_curData)
 	{
 		loadAuxPlotData(std::string());
 		return;
@@ -454,7 +768,7 @@ void ProfilePlotView::setProfile(Profile::Ptr profile)
 	/*
 	 * Check for the "depth" key and remove it
 	 */
-	std::set<std::string> keys(m_curProfile->keys());
+	std::set<std::string> keys(m_curData->series()->keys());
 	bool hasDepth = (keys.find("depth") != keys.end());
 	if (! hasDepth)
 		logging::getLogger("gui.plot")->warning("Profile does not have depth data");
@@ -472,70 +786,38 @@ void ProfilePlotView::setProfile(Profile::Ptr profile)
 		m_cbxAuxKeys->addItem(name, key);
 	}
 
+	m_cbxAuxKeys->setEnabled(m_cbxAuxKeys->count() > 0);
+
+	/*
+	 * Read out Depth first, then the Aux Keys
+	 */
+	if (hasDepth)
+		m_xhKeys.push_back("depth");
+	m_xhKeys.insert(m_xhKeys.end(), keys.begin(), keys.end());
+	createCrosshair();
+
 	/*
 	 * Load the Depth Profile
 	 */
 	if (hasDepth)
 	{
-		bool hasUnit = false;
-		unit_t unit;
+		const ProfilePlotData::channel_t & c = m_curData->channel("depth");
 
-		try
+		std::vector<alarm_group_t>::const_iterator ait;
+		for (ait = m_curData->alarms().begin(); ait != m_curData->alarms().end(); ait++)
 		{
-			unit = unitForQuantity(qtDepth);
-			hasUnit = true;
-		}
-		catch (std::runtime_error & e)
-		{
-		}
-
-		QVector<double> time;
-		QVector<double> depth;
-
-		unsigned int lastAlarm = 0;
-		AlarmPlotItem * curAlarm = 0;
-
-		std::list<waypoint>::const_iterator it;
-		for (it = m_curProfile->profile().begin(); it != m_curProfile->profile().end(); it++)
-		{
-			time.push_back(it->time / 60.0f);
-			if (! hasUnit)
-				depth.push_back(it->data.at("depth"));
-			else
-				depth.push_back(unit.conv->fromNative(it->data.at("depth")));
+			AlarmPlotItem * curAlarm = new AlarmPlotItem(m_pltDepth);
+			curAlarm->setLayer("overlay");
+			for (size_t i = 0; i < ait->times.size(); ++i)
+				curAlarm->addAlarm(ait->times[i], alarmLabel(ait->names[i]), QString());
 
-			if (it->alarms.size() > 0)
-			{
-				std::set<std::string>::const_iterator ait;
-
-				// Group alarms within the same 60 seconds into one item
-				if (((it->time - lastAlarm) > 60) || ! curAlarm)
-				{
-					if (curAlarm)
-					{
-						curAlarm->finalize();
-						m_pltDepth->addItem(curAlarm);
-					}
-
-					curAlarm = new AlarmPlotItem(m_pltDepth);
-					lastAlarm = it->time;
-				}
-
-				for (ait = it->alarms.begin(); ait != it->alarms.end(); ait++)
-					curAlarm->addAlarm(it->time, alarmLabel(* ait), QString());
-			}
-		}
-
-		if (curAlarm)
-		{
-			curAlarm->finalize();
 			m_pltDepth->addItem(curAlarm);
 		}
 
-		if (! hasUnit)
+		if (! c.hasUnit)
 			m_pltDepth->yAxis->setLabel(tr("Depth"));
 		else
-			m_pltDepth->yAxis->setLabel(tr("Depth (%1)").arg(QString(unit.name).toLower()));
+			m_pltDepth->yAxis->setLabel(tr("Depth (%1)").arg(QString(c.unit.name).toLower()));
 
 		QLinearGradient lg(0, 0, 0, 1);
 		lg.setCoordinateMode(QGradient::StretchToDeviceMode);
@@ -545,26 +827,155 @@ void ProfilePlotView::setProfile(Profile::Ptr profile)
 		m_pltDepth->addGraph();
 		m_pltDepth->graph(0)->setBrush(lg);
 		m_pltDepth->graph(0)->setPen(QColor(192, 192, 192, 255));
-		m_pltDepth->graph(0)->setData(time, depth);
+		m_pltDepth->graph(0)->setVisible(false);
+		updateGraphData(m_pltDepth, "depth", true);
+
+		// Don't clamp to the previous Profile's Time Range while rescaling
+		m_syncingRange = true;
 		m_pltDepth->graph(0)->rescaleAxes();
+		m_syncingRange = false;
+		m_timeExtent = m_pltDepth->xAxis->range();
+
+		/*
+		 * The Depth Graph is drawn by the render worker into this item,
+		 * which stays hidden until the first image arrives
+		 */
+		m_depthImage = new QCPItemPixmap(m_pltDepth);
+		m_depthImage->setLayer("main");
+		m_depthImage->setScaled(true, Qt::IgnoreAspectRatio);
+		m_depthImage->setSelectable(false);
+		m_depthImage->setVisible(false);
+		m_pltDepth->addItem(m_depthImage);
+
 		setupTimeAxis();
 		setupDepthAxis();
 		setupAlarms();
-		m_pltDepth->replot();
+		m_pltDepth->queueReplot();
 	}
 
 	/*
-	 * Initialize the Aux Plot
+	 * Initialize the Aux Plot with the preferred Key if the Profile has it.
+	 * The preference is only changed when the user picks a key.
+	 */
+	QString auxKey(m_auxKey);
+	if (keys.find(auxKey.toStdString()) == keys.end())
+		auxKey = m_cbxAuxKeys->itemData(0).toString();
+
+	m_cbxAuxKeys->setCurrentIndex(m_cbxAuxKeys->findData(auxKey));
+	loadAuxPlotData(auxKey.toStdString());
+}
+
+void ProfilePlotView::setTimeRange(const QCPRange & range)
+{
+	if (m_syncingRange || ! m_pltDepth->graphCount())
+		return;
+
+	/*
+	 * Keep the Range within the Profile and no narrower than a minute
 	 */
-	if ((m_cbxAuxKeys->count() == 1) || (keys.find(m_auxKey.toStdString()) == keys.end()))
+	QCPRange r(range);
+	if (r.size() < PLOT_MIN_TIME_SPAN)
 	{
-		setAuxKey(m_cbxAuxKeys->itemData(0).toString());
+		double c = r.center();
+		r.lower = c - PLOT_MIN_TIME_SPAN / 2;
+		r.upper = c + PLOT_MIN_TIME_SPAN / 2;
 	}
-	else if (keys.find(m_auxKey.toStdString()) != keys.end())
+
+	if (r.size() >= m_timeExtent.size())
+		r = m_timeExtent;
+	else if (r.lower < m_timeExtent.lower)
+		r = QCPRange(m_timeExtent.lower, m_timeExtent.lower + r.size());
+	else if (r.upper > m_timeExtent.upper)
+		r = QCPRange(m_timeExtent.upper - r.size(), m_timeExtent.upper);
+
+	/*
+	 * Start an Interaction if the User is dragging or zooming
+	 */
+	if (m_dragging || m_tmrInteract->isActive())
+		beginInteraction();
+
+	/*
+	 * Apply the Range to both Plots
+	 */
+	m_syncingRange = true;
+	m_pltDepth->xAxis->setRange(r);
+	m_pltAux->xAxis->setRange(r);
+	m_syncingRange = false;
+
+	setupTimeAxis();
+	m_pltAux->xAxis->setTickVector(m_pltDepth->xAxis->tickVector());
+
+	/*
+	 * Slice the visible Data for the Graphs drawn on this Thread
+	 */
+	if (m_interacting)
+		updateGraphData(m_pltDepth, "depth", false);
+
+	if (m_pltAux->graphCount() && ! m_auxShown.empty())
+		updateGraphData(m_pltAux, m_auxShown, false);
+
+	m_pltDepth->queueReplot();
+	m_pltAux->queueReplot();
+}
+
+void ProfilePlotView::updateCrosshair(double time)
+{
+	m_xhDepth->point1->setCoords(time, 0);
+	m_xhDepth->point2->setCoords(time, 1);
+	m_xhAux->point1->setCoords(time, 0);
+	m_xhAux->point2->setCoords(time, 1);
+
+	/*
+	 * Build the Readout Text
+	 */
+	int secs = qRound(time * 60);
+	QStringList lines;
+	lines << tr("Time: %1:%2").arg(secs / 60).arg(secs % 60, 2, 10, QChar('0'));
+
+	std::vector<std::string>::const_iterator it;
+	for (it = m_xhKeys.begin(); it != m_xhKeys.end(); it++)
+	{
+		int i = m_curData->nearestSample(* it, time);
+		if (i < 0)
+			continue;
+
+		const ProfilePlotData::channel_t & c = m_curData->channel(* it);
+		QString value(QString::number(c.values[i], 'f', 1));
+		if (c.hasUnit)
+			value += " " + QString::fromStdWString(c.unit.abbr);
+
+		lines << QString("%1: %2").arg(profileKeyLabel(* it)).arg(value);
+	}
+
+	m_xhText->setText(lines.join("\n"));
+
+	/*
+	 * Place the Readout beside the Crosshair, flipping to the left side in
+	 * the right half of the plot
+	 */
+	QRect r = m_pltDepth->axisRect();
+	double px = m_pltDepth->xAxis->coordToPixel(time);
+	if (px > r.center().x())
+	{
+		m_xhText->setPositionAlignment(Qt::AlignRight | Qt::AlignTop);
+		m_xhText->position->setCoords(px - 8, r.top() + 4);
+	}
+	else
+	{
+		m_xhText->setPositionAlignment(Qt::AlignLeft | Qt::AlignTop);
+		m_xhText->position->setCoords(px + 8, r.top() + 4);
+	}
+
+	if (! m_xhShown)
 	{
-		m_cbxAuxKeys->setCurrentIndex(m_cbxAuxKeys->findText(m_auxKey, Qt::MatchFlags()));
-		loadAuxPlotData(m_auxKey.toStdString());
+		m_xhDepth->setVisible(true);
+		m_xhAux->setVisible(true);
+		m_xhText->setVisible(true);
+		m_xhShown = true;
 	}
+
+	m_pltDepth->queueReplot();
+	m_pltAux->queueReplot();
 }
 
 void ProfilePlotView::setupAlarms()
@@ -629,7 +1040,7 @@ void ProfilePlotView::setupTimeAxis()
 	double step = tickStep(m_pltDepth->xAxis->range());
 
 	QVector<double> ticks;
-	double curTick = 0;
+	double curTick = qFloor(m_pltDepth->xAxis->range().lower / step) * step;
 	while (curTick <= m_pltDepth->xAxis->range().upper)
 	{
 		ticks << curTick;
@@ -665,23 +1076,32 @@ double ProfilePlotView::tickStep(const QCPRange & range, int nSteps)
 	return step * factor;
 }
 
-unit_t ProfilePlotView::unitForQuantity(quantity_t q) const
+void ProfilePlotView::updateGraphData(QCustomPlot * plot, const std::string & key, bool fullRange)
 {
-	QSettings s;
-	s.beginGroup("Settings");
-	QVariant uname = s.value(QString("Unit%1").arg(q));
-	s.endGroup();
+	const ProfileLOD::Ptr & lod = m_curData->channel(key).lod;
+	if (! lod->size())
+		return;
 
-	try
-	{
-		if (! uname.isValid())
-			return findUnit(q, 0);
-		else
-			return findUnit(q, (const char *)uname.toByteArray());
-	}
-	catch (std::runtime_error & e)
+	double lower = lod->keys().first();
+	double upper = lod->keys().last();
+	if (! fullRange)
 	{
+		lower = plot->xAxis->range().lower;
+		upper = plot->xAxis->range().upper;
 	}
 
-	return unit_t();
+	QVector<double> keys;
+	QVector<double> values;
+	lod->decimate(lower, upper, plot->width(), keys, values);
+
+#ifdef BENTHOS_PLOT_TIMING
+	QElapsedTimer t;
+	t.start();
+#endif
+
+	plot->graph(0)->setData(keys, values);
+
+#ifdef BENTHOS_PLOT_TIMING
+	logging::getLogger("gui.plot")->debug("setData: %d points in %ld us", keys.size(), (long)(t.nsecsElapsed() / 1000));
+#endif
 }
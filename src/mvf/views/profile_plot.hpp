@@ -29,8 +29,15 @@
  * @author Jonathan Krauss <jkrauss@asymworks.com>
  */
 
+#include <vector>
+
+#include <QAtomicInt>
 #include <QComboBox>
+#include <QElapsedTimer>
+#include <QImage>
 #include <QLabel>
+#include <QThreadPool>
+#include <QTimer>
 #include <QWidget>
 
 #include <util/qcustomplot.h>
@@ -47,6 +54,8 @@
 #include <benthos/logbook/profile.hpp>
 using namespace benthos::logbook;
 
+#include "profile_cache.hpp"
+
 /**
  * @brief Render a Dive as a Plot View
  *
@@ -57,6 +66,22 @@ using namespace benthos::logbook;
  * If a dive contains multiple linked profiles, the control includes a combo
  * box to select the profile to view.  Only one profile may be viewed at a
  * time.
+ *
+ * The depth graph is rasterized on a worker thread by PlotRenderWorker and
+ * displayed as a pixmap item, so the GUI thread only draws the axes, grid
+ * and alarms.  A new image is requested whenever the axis layout changes,
+ * and the previous image is stretched to fit until it arrives.
+ *
+ * The time axis can be zoomed with the mouse wheel and panned by dragging
+ * either plot, and the two plots are kept on the same time range.  While the
+ * user is zooming or panning, the depth graph is drawn directly from a
+ * decimated slice of the visible range with antialiasing disabled, and the
+ * rendered image is restored once the interaction finishes.  Double-clicking
+ * resets the time range to the whole profile.
+ *
+ * Hovering over either plot shows a crosshair on both plots with a readout
+ * of the time and the value of every channel at the cursor.  Each channel's
+ * sample is located by a binary search over its time vector.
  */
 class ProfilePlotView: public QWidget
 {
@@ -73,28 +98,58 @@ public:
 	//! @param[in] Dive to Display
 	void setDive(Dive::Ptr dive);
 
+	/**
+	 * @brief Display a Dive with pre-loaded Profiles
+	 * @param[in] Dive to Display
+	 * @param[in] Profiles belonging to the Dive
+	 * @param[in] Profile to Display
+	 * @param[in] Decoded Plot Data for the Profile (optional)
+	 */
+	void setDive(Dive::Ptr dive, const std::vector<Profile::Ptr> & profiles, Profile::Ptr profile, ProfilePlotData::Ptr data = ProfilePlotData::Ptr());
+
+	/**
+	 * @brief Choose the Profile to Display for a Dive
+	 * @param[in] Dive
+	 * @param[in] Profiles belonging to the Dive
+	 * @return Profile recorded by the Dive's computer, or the first Profile
+	 */
+	static Profile::Ptr defaultProfile(Dive::Ptr dive, const std::vector<Profile::Ptr> & profiles);
+
+	//! @return Quantity Type for an Aux Key
+	static quantity_t profileKeyQuantity(const std::string & key);
+
 protected:
 
+	//! Create the Crosshair Items for the current Profile
+	void createCrosshair();
+
 	//! Create Control Layout
 	void createLayout();
 
+	//! Hide the Crosshair when the Mouse leaves a Plot
+	virtual bool eventFilter(QObject *, QEvent *);
+
 	//! @return Label for an Alarm
 	static QString alarmLabel(const std::string & name);
 
 	//! @return Label for an Aux Key
 	static QString profileKeyLabel(const std::string & key);
 
-	//! @return Quantity Type for an Aux Key
-	static quantity_t profileKeyQuantity(const std::string & key);
-
 	//! @return Label for a Profile
 	static QString profileLabel(Profile::Ptr profile);
 
-	//! @param[in] Aux Key to Display
+	//! Re-decimate the Plot Data for the new Size
+	virtual void resizeEvent(QResizeEvent *);
+
+	//! @param[in] Aux Key to Display and save as the Preferred Key
 	void setAuxKey(const QString & key);
 
-	//! @param[in] Profile to Display
-	void setProfile(Profile::Ptr profile);
+	/**
+	 * @brief Display a Profile
+	 * @param[in] Profile to Display
+	 * @param[in] Decoded Plot Data (loaded from the ProfileCache if empty)
+	 */
+	void setProfile(Profile::Ptr profile, ProfilePlotData::Ptr data = ProfilePlotData::Ptr());
 
 	//! Setup the Alarm Items
 	void setupAlarms();
@@ -117,13 +172,38 @@ protected:
 	static double tickStep(const QCPRange & range, int nSteps = 7);
 
 protected slots:
-	void cbxAuxKeysIndexChanged(int);
-	void cbxProfileIndexChanged(int);
+	void cbxAuxKeysActivated(int);
+	void cbxProfileActivated(int);
+	void onInteractTimer();
+	void pltAuxRangeChanged(const QCPRange &);
+	void pltDepthRangeChanged(const QCPRange &);
+	void pltMouseDoubleClick(QMouseEvent *);
+	void pltMouseMove(QMouseEvent *);
+	void pltMousePress(QMouseEvent *);
+	void pltMouseRelease(QMouseEvent *);
+	void pltMouseWheel(QWheelEvent *);
+	void pltDepthAfterReplot();
 	void pltDepthBeforeReplot();
 
+	/**
+	 * @brief Display a Rendered Depth Graph
+	 * @param[in] Serial Number of the Render Request
+	 * @param[in] Rendered Image of the Axis Rectangle
+	 */
+	void onDepthRendered(int, const QImage &);
+
 private:
+	static QString formatAlarmLabel(const QVariant &);
+	static QString formatProfileKeyLabel(const QVariant &);
+
+	void beginInteraction();
+	void endInteraction();
+	void hideCrosshair();
 	void loadAuxPlotData(const std::string &);
-	unit_t unitForQuantity(quantity_t) const;
+	void requestDepthRender();
+	void setTimeRange(const QCPRange &);
+	void updateCrosshair(double);
+	void updateGraphData(QCustomPlot *, const std::string &, bool);
 
 private:
 	QLabel *			m_lblProfile;
@@ -134,7 +214,29 @@ private:
 
 	Dive::Ptr			m_curDive;
 	Profile::Ptr		m_curProfile;
+	ProfilePlotData::Ptr	m_curData;
+	std::vector<Profile::Ptr>	m_profiles;
 	QString				m_auxKey;
+	std::string			m_auxShown;
+
+	QElapsedTimer		m_tmrReplot;
+	QVector<double>		m_plotLayout;
+
+	QCPItemPixmap *		m_depthImage;
+	QThreadPool *		m_renderPool;
+	QAtomicInt			m_renderGen;
+
+	QCPRange			m_timeExtent;
+	QTimer *			m_tmrInteract;
+	bool				m_dragging;
+	bool				m_interacting;
+	bool				m_syncingRange;
+
+	QCPItemStraightLine *	m_xhDepth;
+	QCPItemStraightLine *	m_xhAux;
+	QCPItemText *		m_xhText;
+	std::vector<std::string>	m_xhKeys;
+	bool				m_xhShown;
 
 };
 
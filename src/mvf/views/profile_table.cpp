@@ -19,22 +19,47 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
  * 02110-1301, USA.
  */
-
+#include <QEvent>
 #include <QFontMetrics>
 #include <QPainter>
 #include <QPaintEvent>
-#include <QSettings>
+
+#include <boost/bind.hpp>
 
 #include "profile_table.hpp"
-#include "util/units.hpp"
+#include "util/formatcache.hpp"
 
 ProfileTableView::ProfileTableView(QWidget * parent)
-	: QWidget(parent), m_Dive()
+	: QWidget(parent), m_Dive(), m_layout(), m_layoutValid(false), m_pixmap(), m_pixmapKey(), m_evtAttrSet()
 {
 }
 
 ProfileTableView::~ProfileTableView()
 {
+	if (m_evtAttrSet.connected())
+		m_evtAttrSet.disconnect();
+}
+
+void ProfileTableView::changeEvent(QEvent * e)
+{
+	if ((e->type() == QEvent::FontChange) || (e->type() == QEvent::LanguageChange))
+	{
+		m_layoutValid = false;
+		m_pixmapKey.clear();
+		update();
+	}
+
+	QWidget::changeEvent(e);
+}
+
+void ProfileTableView::diveChanged(Persistent::Ptr obj, const std::string &, const boost::any &)
+{
+	if (! m_Dive || (obj != boost::dynamic_pointer_cast<Persistent>(m_Dive)))
+		return;
+
+	// Re-render on the next Paint
+	m_pixmapKey.clear();
+	update();
 }
 
 QSize ProfileTableView::minimumSizeHint() const
@@ -47,23 +72,39 @@ void ProfileTableView::paintEvent(QPaintEvent * e)
 	unit_t u;
 
 	//! Lookup the Unit Abbreviation
-	QSettings s;
-	s.beginGroup("Settings");
-	QVariant uname = s.value(QString("Unit%1").arg(qtDepth));
-	s.endGroup();
-
 	try
 	{
-		if (! uname.isValid())
-			u = findUnit(qtDepth, 0);
-		else
-			u = findUnit(qtDepth, (const char *)uname.toByteArray());
+		u = FormatCache::Instance()->unit(qtDepth);
 	}
 	catch (std::runtime_error & e)
 	{
 		u = findUnit(qtDepth, 0);
 	}
 
+	/*
+	 * Re-render the Table only if the Dive, Size or Unit has changed
+	 */
+	QString key = QString("%1/%2x%3/%4")
+		.arg(m_Dive ? (qlonglong)m_Dive->id() : -1)
+		.arg(width())
+		.arg(height())
+		.arg(u.name);
+
+	if (m_pixmap.isNull() || (key != m_pixmapKey))
+	{
+		updateLayout();
+		renderTable(u);
+		m_pixmapKey = key;
+	}
+
+	QPainter painter(this);
+	painter.drawPixmap(e->rect(), m_pixmap, e->rect());
+}
+
+void ProfileTableView::renderTable(const unit_t & u)
+{
+	const layout_t & l = m_layout;
+
 	// Value Strings
 	QString interval;
 	QString pgStart;
@@ -123,82 +164,11 @@ void ProfileTableView::paintEvent(QPaintEvent * e)
 		}
 	}
 
-	// Get the Large and Small Fonts
-	QFont fL(font());	fL.setPixelSize(fontInfo().pixelSize() * 5 / 3);
-	QFont fM(font());	fM.setPixelSize(fontInfo().pixelSize() * 5 / 4);
-	QFont fS(font());	fS.setPixelSize(fontInfo().pixelSize() * 3 / 4);
-	QFont fB(font());	fB.setWeight(QFont::Bold);
-
-	QFontMetrics fmL(fL);
-	QFontMetrics fmM(fS);
-	QFontMetrics fmS(fS);
-	QFontMetrics fmB(fB);
-
-	// Calculate the ideal (10:7) rectangle
-	QRect contentRect;
-	int cw = width();
-	int ch = height();
-
-	if (ch > cw * 7 / 10)
-	{
-		// Letterbox
-		contentRect.setWidth(cw);
-		contentRect.setHeight(cw * 7 / 10);
-		contentRect.translate(0, (ch - contentRect.height()) / 2);
-	}
-	else
-	{
-		// Pillarbox
-		contentRect.setWidth(ch * 10 / 7);
-		contentRect.setHeight(ch);
-		contentRect.translate((cw - contentRect.width()) / 2, 0);
-	}
-
-	// Calculate the other Rect's
-	QRect intervalRect;
-	QRect pgStartRect;
-	QRect pgEndRect;
-	QRect depthRect;
-	QRect btimeRect;
-	QRect stopRect;
-
-	QRect ntValRect;
-	QRect ntRect;
-
-	intervalRect.setHeight(0.20 * contentRect.height());
-	intervalRect.setWidth(0.20 * contentRect.width());
-	intervalRect.translate(0, 0);
-
-	pgStartRect.setHeight(0.20 * contentRect.height());
-	pgStartRect.setWidth(0.10 * contentRect.width());
-	pgStartRect.translate(0.20 * contentRect.width(), 0);
-
-	pgEndRect.setHeight(0.20 * contentRect.height());
-	pgEndRect.setWidth(0.10 * contentRect.width());
-	pgEndRect.translate(0.90 * contentRect.width(), 0);
-
-	depthRect.setHeight(0.10 * contentRect.height());
-	depthRect.setWidth(fmS.width(tr("MAX DEPTH")) * 3 / 2);
-	depthRect.translate((0.30 * contentRect.width() - depthRect.width()) / 2, 0.40 * contentRect.height());
-
-	btimeRect.setHeight(0.10 * contentRect.height());
-	btimeRect.setWidth(fmS.width(tr("BOTTOM TIME")) * 3 / 2);
-	btimeRect.translate(0.35 * contentRect.width() + (0.25 * contentRect.width() - btimeRect.width()) / 2, 0.82 * contentRect.height());
-
-	stopRect.setHeight(0.10 * contentRect.height());
-	stopRect.setWidth(fmS.width(tr("SAFETY STOP")) * 5 / 3);
-	stopRect.translate(0.75 * contentRect.width() + (0.20 * contentRect.width() - stopRect.width()) / 2, 0.35 * contentRect.height());
-
-	ntValRect.setHeight(fmB.height() * 5 / 4);
-	ntValRect.setWidth(fmB.width("0000") * 5 / 4);
-	ntValRect.translate(0.75 * contentRect.width() + fmS.width("TNT: "), 0.60 * contentRect.height());
+	// Setup the Pixmap and Painter
+	m_pixmap = QPixmap(size());
+	m_pixmap.fill(Qt::transparent);
 
-	ntRect.setHeight(ntValRect.height());
-	ntRect.setWidth(fmS.width("TNT: ") + fmS.width("min") + ntValRect.width());
-	ntRect.translate(0.75 * contentRect.width(), 0.60 * contentRect.height());
-
-	// Setup the Painter
-	QPainter painter(this);
+	QPainter painter(& m_pixmap);
 	painter.setRenderHint(QPainter::Antialiasing);
 	painter.setBrush(Qt::NoBrush);
 	painter.setPen(Qt::NoPen);
@@ -207,20 +177,9 @@ void ProfileTableView::paintEvent(QPaintEvent * e)
 	painter.save();
 	painter.setPen(Qt::NoPen);
 	painter.setBrush(Qt::white);
-	painter.drawRect(contentRect);
+	painter.drawRect(l.contentRect);
 	painter.restore();
 
-	// Setup the Profile Path
-	QPainterPath ppProfile;
-	ppProfile.moveTo(0, 0);
-	ppProfile.lineTo(0.30 * contentRect.width(), 0);
-	ppProfile.lineTo(0.35 * contentRect.width(), 0.60 * contentRect.height());
-	ppProfile.lineTo(0.60 * contentRect.width(), 0.60 * contentRect.height());
-	ppProfile.lineTo(0.75 * contentRect.width(), 0.15 * contentRect.height());
-	ppProfile.lineTo(0.85 * contentRect.width(), 0.15 * contentRect.height());
-	ppProfile.lineTo(0.90 * contentRect.width(), 0);
-	ppProfile.lineTo(1.00 * contentRect.width(), 0);
-
 	// Depth Profile Brush
 	QLinearGradient lg(0, 0, 0, 1);
 	lg.setCoordinateMode(QGradient::StretchToDeviceMode);
@@ -229,157 +188,157 @@ void ProfileTableView::paintEvent(QPaintEvent * e)
 
 	// Draw the Depth Profile
 	painter.save();
-	painter.translate(contentRect.topLeft());
-	painter.translate(0, 0.20 * contentRect.height());
+	painter.translate(l.contentRect.topLeft());
+	painter.translate(0, 0.20 * l.contentRect.height());
 	painter.setPen(QPen(QColor(112, 112, 112, 255), 2));
 	painter.setBrush(lg);
-	painter.drawPath(ppProfile);
+	painter.drawPath(l.ppProfile);
 	painter.restore();
 
 	// Draw the Surface Interval / PGStart Separator
 	painter.save();
-	painter.translate(contentRect.topLeft());
-	painter.translate(intervalRect.width(), 0.20 * contentRect.height());
+	painter.translate(l.contentRect.topLeft());
+	painter.translate(l.intervalRect.width(), 0.20 * l.contentRect.height());
 	painter.setPen(QPen(Qt::black, 2));
 	painter.drawLine(
-		-fmL.height() / 8,	-fmL.height() / 4,
-		 fmL.height() / 8,  -fmL.height()
+		-l.hL / 8,	-l.hL / 4,
+		 l.hL / 8,  -l.hL
 	);
 	painter.restore();
 
 	// Draw the Surface Interval and Pressure Groups
 	painter.save();
-	painter.translate(contentRect.topLeft());
+	painter.translate(l.contentRect.topLeft());
 	painter.setPen(Qt::black);
 	painter.setPen(Qt::NoBrush);
-	painter.setFont(fL);
-	painter.drawText(intervalRect, Qt::AlignHCenter | Qt::AlignBottom, interval);
-	painter.drawText(pgStartRect, Qt::AlignHCenter | Qt::AlignBottom, pgStart);
-	painter.drawText(pgEndRect, Qt::AlignHCenter | Qt::AlignBottom, pgEnd);
-	painter.translate(0, intervalRect.height() + fmS.height() / 2);
-	painter.setFont(fS);
-	painter.drawText(intervalRect, Qt::AlignHCenter | Qt::AlignTop, tr("INTERVAL"));
-	painter.drawText(pgStartRect, Qt::AlignHCenter | Qt::AlignTop, tr("PG"));
-	painter.drawText(pgEndRect, Qt::AlignHCenter | Qt::AlignTop, tr("PG"));
+	painter.setFont(l.fL);
+	painter.drawText(l.intervalRect, Qt::AlignHCenter | Qt::AlignBottom, interval);
+	painter.drawText(l.pgStartRect, Qt::AlignHCenter | Qt::AlignBottom, pgStart);
+	painter.drawText(l.pgEndRect, Qt::AlignHCenter | Qt::AlignBottom, pgEnd);
+	painter.translate(0, l.intervalRect.height() + l.hS / 2);
+	painter.setFont(l.fS);
+	painter.drawText(l.intervalRect, Qt::AlignHCenter | Qt::AlignTop, l.lblInterval);
+	painter.drawText(l.pgStartRect, Qt::AlignHCenter | Qt::AlignTop, l.lblPG);
+	painter.drawText(l.pgEndRect, Qt::AlignHCenter | Qt::AlignTop, l.lblPG);
 	painter.restore();
 
 	// Draw the Depth Information
 	painter.save();
-	painter.translate(contentRect.topLeft());
+	painter.translate(l.contentRect.topLeft());
 	painter.setPen(Qt::black);
 	painter.setPen(Qt::NoBrush);
-	painter.setFont(fM);
-	painter.drawText(depthRect, Qt::AlignHCenter | Qt::AlignBottom, depth);
+	painter.setFont(l.fM);
+	painter.drawText(l.depthRect, Qt::AlignHCenter | Qt::AlignBottom, depth);
 	painter.save();
 	painter.setRenderHint(QPainter::Antialiasing, false);
 	painter.setPen(QColor(112, 112, 112, 255));
 	painter.drawLine(
-		depthRect.bottomLeft(),
-		depthRect.bottomRight()
+		l.depthRect.bottomLeft(),
+		l.depthRect.bottomRight()
 	);
 	painter.restore();
-	painter.translate(0, depthRect.height() + fmS.height() / 4);
-	painter.setFont(fS);
-	painter.drawText(depthRect, Qt::AlignHCenter | Qt::AlignTop, tr("MAX DEPTH"));
+	painter.translate(0, l.depthRect.height() + l.hS / 4);
+	painter.setFont(l.fS);
+	painter.drawText(l.depthRect, Qt::AlignHCenter | Qt::AlignTop, l.lblDepth);
 	painter.restore();
 
 	// Draw the Bottom Time Information
 	painter.save();
-	painter.translate(contentRect.topLeft());
+	painter.translate(l.contentRect.topLeft());
 	painter.setPen(Qt::black);
 	painter.setPen(Qt::NoBrush);
-	painter.setFont(fM);
-	painter.drawText(btimeRect, Qt::AlignHCenter | Qt::AlignBottom, btime);
+	painter.setFont(l.fM);
+	painter.drawText(l.btimeRect, Qt::AlignHCenter | Qt::AlignBottom, btime);
 	painter.save();
 	painter.setRenderHint(QPainter::Antialiasing, false);
 	painter.setPen(QColor(112, 112, 112, 255));
 	painter.drawLine(
-		btimeRect.bottomLeft(),
-		btimeRect.bottomRight()
+		l.btimeRect.bottomLeft(),
+		l.btimeRect.bottomRight()
 	);
 	painter.restore();
-	painter.translate(0, btimeRect.height() + fmS.height() / 4);
-	painter.setFont(fS);
-	painter.drawText(btimeRect, Qt::AlignHCenter | Qt::AlignTop, tr("BOTTOM TIME"));
+	painter.translate(0, l.btimeRect.height() + l.hS / 4);
+	painter.setFont(l.fS);
+	painter.drawText(l.btimeRect, Qt::AlignHCenter | Qt::AlignTop, l.lblBottomTime);
 	painter.restore();
 
 	// Draw the Safety Stop Information
 	painter.save();
-	painter.translate(contentRect.topLeft());
+	painter.translate(l.contentRect.topLeft());
 	painter.setPen(Qt::black);
 	painter.setPen(Qt::NoBrush);
-	painter.setFont(fM);
-	painter.drawText(stopRect, Qt::AlignHCenter | Qt::AlignBottom, sstop);
+	painter.setFont(l.fM);
+	painter.drawText(l.stopRect, Qt::AlignHCenter | Qt::AlignBottom, sstop);
 	painter.save();
 	painter.setRenderHint(QPainter::Antialiasing, false);
 	painter.setPen(QColor(112, 112, 112, 255));
 	painter.drawLine(
-		stopRect.bottomLeft(),
-		stopRect.bottomRight()
+		l.stopRect.bottomLeft(),
+		l.stopRect.bottomRight()
 	);
 	painter.restore();
-	painter.translate(0, stopRect.height() + fmS.height() / 4);
-	painter.setFont(fS);
-	painter.drawText(stopRect, Qt::AlignHCenter | Qt::AlignTop, tr("SAFETY STOP"));
+	painter.translate(0, l.stopRect.height() + l.hS / 4);
+	painter.setFont(l.fS);
+	painter.drawText(l.stopRect, Qt::AlignHCenter | Qt::AlignTop, l.lblSafetyStop);
 	painter.restore();
 
 	// Draw the Nitrogen Time Table
 	painter.save();
-	painter.translate(contentRect.topLeft());
+	painter.translate(l.contentRect.topLeft());
 	painter.setPen(Qt::black);
 	painter.setPen(Qt::NoBrush);
 	// RNT
 	painter.save();
-	painter.setFont(fB);
-	painter.drawText(ntValRect, Qt::AlignCenter | Qt::AlignBottom, rnt);
-	painter.setFont(fS);
-	painter.drawText(ntRect, Qt::AlignLeft | Qt::AlignBottom, tr("RNT:"));
-	painter.drawText(ntRect, Qt::AlignRight | Qt::AlignBottom, tr("min"));
+	painter.setFont(l.fB);
+	painter.drawText(l.ntValRect, Qt::AlignCenter | Qt::AlignBottom, rnt);
+	painter.setFont(l.fS);
+	painter.drawText(l.ntRect, Qt::AlignLeft | Qt::AlignBottom, l.lblRNT);
+	painter.drawText(l.ntRect, Qt::AlignRight | Qt::AlignBottom, l.lblMin);
 	painter.setRenderHint(QPainter::Antialiasing, false);
 	painter.setPen(QColor(112, 112, 112, 255));
 	painter.drawLine(
-		ntValRect.bottomLeft(),
-		ntValRect.bottomRight()
+		l.ntValRect.bottomLeft(),
+		l.ntValRect.bottomRight()
 	);
 	painter.restore();
-	painter.translate(0, ntRect.height());
+	painter.translate(0, l.ntRect.height());
 	// ABT
 	painter.save();
-	painter.setFont(fB);
-	painter.drawText(ntValRect, Qt::AlignCenter | Qt::AlignBottom, abt);
-	painter.setFont(fS);
-	painter.drawText(ntRect, Qt::AlignLeft | Qt::AlignBottom, tr("ABT:"));
-	painter.drawText(ntRect, Qt::AlignRight | Qt::AlignBottom, tr("min"));
+	painter.setFont(l.fB);
+	painter.drawText(l.ntValRect, Qt::AlignCenter | Qt::AlignBottom, abt);
+	painter.setFont(l.fS);
+	painter.drawText(l.ntRect, Qt::AlignLeft | Qt::AlignBottom, l.lblABT);
+	painter.drawText(l.ntRect, Qt::AlignRight | Qt::AlignBottom, l.lblMin);
 	painter.setRenderHint(QPainter::Antialiasing, false);
 	painter.setPen(QColor(112, 112, 112, 255));
 	painter.drawLine(
-		ntValRect.bottomLeft(),
-		ntValRect.bottomRight()
+		l.ntValRect.bottomLeft(),
+		l.ntValRect.bottomRight()
 	);
 	painter.restore();
-	painter.translate(0, ntRect.height());
+	painter.translate(0, l.ntRect.height());
 	// Line
 	painter.save();
 	painter.setRenderHint(QPainter::Antialiasing, false);
 	painter.setPen(QColor(192, 192, 192, 255));
 	painter.drawLine(
-		ntRect.left(), ntRect.center().y(),
-		ntRect.right(), ntRect.center().y()
+		l.ntRect.left(), l.ntRect.center().y(),
+		l.ntRect.right(), l.ntRect.center().y()
 	);
 	painter.restore();
-	painter.translate(0, ntRect.height() / 2);
+	painter.translate(0, l.ntRect.height() / 2);
 	// TBT
 	painter.save();
-	painter.setFont(fB);
-	painter.drawText(ntValRect, Qt::AlignCenter | Qt::AlignBottom, tbt);
-	painter.setFont(fS);
-	painter.drawText(ntRect, Qt::AlignLeft | Qt::AlignBottom, tr("TBT:"));
-	painter.drawText(ntRect, Qt::AlignRight | Qt::AlignBottom, tr("min"));
+	painter.setFont(l.fB);
+	painter.drawText(l.ntValRect, Qt::AlignCenter | Qt::AlignBottom, tbt);
+	painter.setFont(l.fS);
+	painter.drawText(l.ntRect, Qt::AlignLeft | Qt::AlignBottom, l.lblTBT);
+	painter.drawText(l.ntRect, Qt::AlignRight | Qt::AlignBottom, l.lblMin);
 	painter.setRenderHint(QPainter::Antialiasing, false);
 	painter.setPen(QColor(112, 112, 112, 255));
 	painter.drawLine(
-		ntValRect.bottomLeft(),
-		ntValRect.bottomRight()
+		l.ntValRect.bottomLeft(),
+		l.ntValRect.bottomRight()
 	);
 	painter.restore();
 	painter.restore();
@@ -387,11 +346,126 @@ void ProfileTableView::paintEvent(QPaintEvent * e)
 
 void ProfileTableView::setDive(Dive::Ptr dive)
 {
+	// Always re-render, since the Dive may have been edited
 	m_Dive = dive;
+	m_pixmapKey.clear();
 	update();
+
+	// The Attribute Event is shared by all Dives, so connect only once
+	if (m_Dive && ! m_evtAttrSet.connected())
+		m_evtAttrSet = m_Dive->events().attr_set.connect(boost::bind(& ProfileTableView::diveChanged, this, _1, _2, _3));
 }
 
 QSize ProfileTableView::sizeHint() const
 {
 	return QSize(600, 420);
 }
+
+void ProfileTableView::updateLayout()
+{
+	if (m_layoutValid && (m_layout.size == size()))
+		return;
+
+	layout_t & l = m_layout;
+	l.size = size();
+
+	// Get the Large and Small Fonts
+	l.fL = font();	l.fL.setPixelSize(fontInfo().pixelSize() * 5 / 3);
+	l.fM = font();	l.fM.setPixelSize(fontInfo().pixelSize() * 5 / 4);
+	l.fS = font();	l.fS.setPixelSize(fontInfo().pixelSize() * 3 / 4);
+	l.fB = font();	l.fB.setWeight(QFont::Bold);
+
+	QFontMetrics fmL(l.fL);
+	QFontMetrics fmS(l.fS);
+	QFontMetrics fmB(l.fB);
+
+	l.hL = fmL.height();
+	l.hS = fmS.height();
+
+	// Translate the Labels
+	l.lblInterval = tr("INTERVAL");
+	l.lblPG = tr("PG");
+	l.lblDepth = tr("MAX DEPTH");
+	l.lblBottomTime = tr("BOTTOM TIME");
+	l.lblSafetyStop = tr("SAFETY STOP");
+	l.lblRNT = tr("RNT:");
+	l.lblABT = tr("ABT:");
+	l.lblTBT = tr("TBT:");
+	l.lblMin = tr("min");
+
+	// Calculate the ideal (10:7) rectangle
+	int cw = width();
+	int ch = height();
+
+	l.contentRect = QRect();
+	if (ch > cw * 7 / 10)
+	{
+		// Letterbox
+		l.contentRect.setWidth(cw);
+		l.contentRect.setHeight(cw * 7 / 10);
+		l.contentRect.translate(0, (ch - l.contentRect.height()) / 2);
+	}
+	else
+	{
+		// Pillarbox
+		l.contentRect.setWidth(ch * 10 / 7);
+		l.contentRect.setHeight(ch);
+		l.contentRect.translate((cw - l.contentRect.width()) / 2, 0);
+	}
+
+	// Calculate the other Rect's
+	const QRect & c = l.contentRect;
+
+	l.intervalRect = QRect();
+	l.intervalRect.setHeight(0.20 * c.height());
+	l.intervalRect.setWidth(0.20 * c.width());
+	l.intervalRect.translate(0, 0);
+
+	l.pgStartRect = QRect();
+	l.pgStartRect.setHeight(0.20 * c.height());
+	l.pgStartRect.setWidth(0.10 * c.width());
+	l.pgStartRect.translate(0.20 * c.width(), 0);
+
+	l.pgEndRect = QRect();
+	l.pgEndRect.setHeight(0.20 * c.height());
+	l.pgEndRect.setWidth(0.10 * c.width());
+	l.pgEndRect.translate(0.90 * c.width(), 0);
+
+	l.depthRect = QRect();
+	l.depthRect.setHeight(0.10 * c.height());
+	l.depthRect.setWidth(fmS.width(l.lblDepth) * 3 / 2);
+	l.depthRect.translate((0.30 * c.width() - l.depthRect.width()) / 2, 0.40 * c.height());
+
+	l.btimeRect = QRect();
+	l.btimeRect.setHeight(0.10 * c.height());
+	l.btimeRect.setWidth(fmS.width(l.lblBottomTime) * 3 / 2);
+	l.btimeRect.translate(0.35 * c.width() + (0.25 * c.width() - l.btimeRect.width()) / 2, 0.82 * c.height());
+
+	l.stopRect = QRect();
+	l.stopRect.setHeight(0.10 * c.height());
+	l.stopRect.setWidth(fmS.width(l.lblSafetyStop) * 5 / 3);
+	l.stopRect.translate(0.75 * c.width() + (0.20 * c.width() - l.stopRect.width()) / 2, 0.35 * c.height());
+
+	l.ntValRect = QRect();
+	l.ntValRect.setHeight(fmB.height() * 5 / 4);
+	l.ntValRect.setWidth(fmB.width("0000") * 5 / 4);
+	l.ntValRect.translate(0.75 * c.width() + fmS.width("TNT: "), 0.60 * c.height());
+
+	l.ntRect = QRect();
+	l.ntRect.setHeight(l.ntValRect.height());
+	l.ntRect.setWidth(fmS.width("TNT: ") + fmS.width("min") + l.ntValRect.width());
+	l.ntRect.translate(0.75 * c.width(), 0.60 * c.height());
+
+	// Setup the Profile Path
+	l.ppProfile = QPainterPath();
+	l.ppProfile.moveTo(0, 0);
+	l.ppProfile.lineTo(0.30 * c.width(), 0);
+	l.ppProfile.lineTo(0.35 * c.width(), 0.60 * c.height());
+	l.ppProfile.lineTo(0.60 * c.width(), 0.60 * c.height());
+	l.ppProfile.lineTo(0.75 * c.width(), 0.15 * c.height());
+	l.ppProfile.lineTo(0.85 * c.width(), 0.15 * c.height());
+	l.ppProfile.lineTo(0.90 * c.width(), 0);
+	l.ppProfile.lineTo(1.00 * c.width(), 0);
+
+	m_layoutValid = true;
+}
@@ -29,10 +29,28 @@
  * @author Jonathan Krauss <jkrauss@asymworks.com>
  */
 
+#include <QFont>
+#include <QPainterPath>
+#include <QPixmap>
+#include <QRect>
 #include <QSize>
+#include <QString>
 #include <QWidget>
 
+#include <boost/any.hpp>
+#include <boost/signals2.hpp>
+
+#include <util/units.hpp>
+
+/*
+ * FIX for broken Qt4 moc and BOOST_JOIN error
+ */
+#ifdef Q_MOC_RUN
+#define BOOST_NO_TEMPLATE_PARTIAL_SPECIALIZATION
+#endif
+
 #include <benthos/logbook/dive.hpp>
+#include <benthos/logbook/persistent.hpp>
 using namespace benthos::logbook;
 
 /**
@@ -41,6 +59,12 @@ using namespace benthos::logbook;
  * Renders a "table" view of a dive - a square profile with text indicating
  * the maximum depth, bottom time, surface interval, safety stops, pressure
  * groups and nitrogen time table.
+ *
+ * The fonts, rectangles and profile path are computed once per widget size,
+ * and the table is rendered into a pixmap keyed by the dive, widget size and
+ * depth unit.  Repaints which do not change any of these only blit the
+ * pixmap.  The pixmap is also discarded when an attribute of the displayed
+ * dive is set, so edits to the dive are shown immediately.
  */
 class ProfileTableView: public QWidget
 {
@@ -63,12 +87,69 @@ public:
 
 protected:
 
+	//! @brief Invalidate the Caches when the Font or Language changes
+	virtual void changeEvent(QEvent * e);
+
 	//! @brief Render the Widget
 	virtual void paintEvent(QPaintEvent * e);
 
+private:
+
+	//! Cached Layout for a Widget Size
+	typedef struct
+	{
+		QSize			size;
+
+		QFont			fL;
+		QFont			fM;
+		QFont			fS;
+		QFont			fB;
+		int				hL;
+		int				hS;
+
+		QRect			contentRect;
+		QRect			intervalRect;
+		QRect			pgStartRect;
+		QRect			pgEndRect;
+		QRect			depthRect;
+		QRect			btimeRect;
+		QRect			stopRect;
+		QRect			ntValRect;
+		QRect			ntRect;
+
+		QPainterPath	ppProfile;
+
+		QString			lblInterval;
+		QString			lblPG;
+		QString			lblDepth;
+		QString			lblBottomTime;
+		QString			lblSafetyStop;
+		QString			lblRNT;
+		QString			lblABT;
+		QString			lblTBT;
+		QString			lblMin;
+	} layout_t;
+
+	//! Recompute the Layout if the Widget Size has changed
+	void updateLayout();
+
+	//! Dive Attribute Event Handler
+	void diveChanged(Persistent::Ptr obj, const std::string & field, const boost::any & value);
+
+	//! Render the Table into the Pixmap
+	void renderTable(const unit_t & u);
+
 private:
 	Dive::Ptr			m_Dive;
 
+	layout_t			m_layout;
+	bool				m_layoutValid;
+
+	QPixmap				m_pixmap;
+	QString				m_pixmapKey;
+
+	boost::signals2::connection	m_evtAttrSet;
+
 };
 
 #endif /* PROFILE_TABLE_HPP_ */
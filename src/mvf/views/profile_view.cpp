@@ -34,8 +34,18 @@ using namespace benthos;
 #include "profile_view.hpp"
 
 ProfileView::ProfileView(QWidget * parent)
-	: QFrame(parent), m_pvPlot(0), m_pvTable(0), m_pvBlank(0), m_swView(0)
+	: QFrame(parent), m_pvPlot(0), m_pvTable(0), m_pvBlank(0), m_swView(0),
+	  m_pendingDive(), m_tmrLoad(0), m_loadPool(0), m_loadGen(0)
 {
+	m_loadPool = new QThreadPool(this);
+	m_loadPool->setMaxThreadCount(1);
+
+	// Coalesce Requests made before control returns to the Event Loop
+	m_tmrLoad = new QTimer(this);
+	m_tmrLoad->setInterval(0);
+	m_tmrLoad->setSingleShot(true);
+	connect(m_tmrLoad, SIGNAL(timeout()), this, SLOT(onLoadTimer()));
+
 	m_pvPlot = new ProfilePlotView;
 	m_pvTable = new ProfileTableView;
 
@@ -72,10 +82,16 @@ ProfileView::ProfileView(QWidget * parent)
 
 ProfileView::~ProfileView()
 {
+	// Cancel any pending Load before the Generation Counter is destroyed
+	m_loadGen.ref();
+	m_loadPool->waitForDone();
 }
 
-void ProfileView::setDive(Dive::Ptr dive)
+void ProfileView::onLoadTimer()
 {
+	Dive::Ptr dive = m_pendingDive;
+	m_pendingDive.reset();
+
 	if (! dive)
 	{
 		m_swView->setCurrentWidget(m_pvBlank);
@@ -85,17 +101,46 @@ void ProfileView::setDive(Dive::Ptr dive)
 		return;
 	}
 
-	//TODO: Use Collection
-	IProfileFinder::Ptr pf = boost::dynamic_pointer_cast<IProfileFinder>(dive->session()->finder<Profile>());
-	std::vector<Profile::Ptr> p = pf->findByDive(dive->id());
-	if (! p.empty())
+	// Look up the Profiles here, the Session may only be used from the GUI thread
+	profile_load_t request;
+	request.dive = dive;
+	request.profiles = ProfileCache::Instance()->profiles(dive);
+	if (request.profiles.empty())
 	{
+		onProfileLoaded((int)m_loadGen, request);
+		return;
+	}
+
+	request.profile = ProfilePlotView::defaultProfile(dive, request.profiles);
+
+	ProfileLoadWorker * worker = new ProfileLoadWorker(request, & m_loadGen, (int)m_loadGen);
+	connect(worker, SIGNAL(loaded(int, const profile_load_t &)), this, SLOT(onProfileLoaded(int, const profile_load_t &)), Qt::QueuedConnection);
+	m_loadPool->start(worker);
+}
+
+void ProfileView::onProfileLoaded(int serial, const profile_load_t & result)
+{
+	// Drop Results for superseded Requests
+	if (serial != (int)m_loadGen)
+		return;
+
+	if (! result.profiles.empty())
+	{
+		m_pvPlot->setDive(result.dive, result.profiles, result.profile, result.data);
 		m_swView->setCurrentWidget(m_pvPlot);
-		m_pvPlot->setDive(dive);
 	}
 	else
 	{
+		m_pvTable->setDive(result.dive);
 		m_swView->setCurrentWidget(m_pvTable);
-		m_pvTable->setDive(dive);
 	}
 }
+
+void ProfileView::setDive(Dive::Ptr dive)
+{
+	// Supersede any in-flight Load
+	m_loadGen.ref();
+
+	m_pendingDive = dive;
+	m_tmrLoad->start();
+}
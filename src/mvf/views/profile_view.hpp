@@ -29,9 +29,12 @@
  * @author Jonathan Krauss <jkrauss@asymworks.com>
  */
 
+#include <QAtomicInt>
 #include <QComboBox>
 #include <QStackedWidget>
 #include <QFrame>
+#include <QThreadPool>
+#include <QTimer>
 #include <QWidget>
 
 /*
@@ -48,6 +51,8 @@ using namespace benthos::logbook;
 #include "profile_plot.hpp"
 #include "profile_table.hpp"
 
+#include "workers/profileloadworker.hpp"
+
 /**
  * @brief Dive Profile View Widget
  *
@@ -55,6 +60,12 @@ using namespace benthos::logbook;
  * select which profile to view, if a dive has more than one, and displays
  * either a depth plot or a table chart showing max depth, pressure groups
  * and RNT/TBT numbers.
+ *
+ * Dives are loaded asynchronously.  setDive() only records the requested
+ * dive; once control returns to the event loop its profiles are looked up in
+ * the logbook on the GUI thread and then decoded on a worker thread, and only
+ * the result for the most recently requested dive is displayed.  Scrolling quickly through the dive list
+ * therefore renders only the dive the user stops on.
  */
 class ProfileView: public QFrame
 {
@@ -71,12 +82,21 @@ public:
 	//! @param[in] Dive to Display
 	void setDive(Dive::Ptr dive);
 
+protected slots:
+	void onLoadTimer();
+	void onProfileLoaded(int, const profile_load_t &);
+
 private:
 	ProfilePlotView *	m_pvPlot;
 	ProfileTableView *	m_pvTable;
 	QWidget *			m_pvBlank;
 	QStackedWidget *	m_swView;
 
+	Dive::Ptr			m_pendingDive;
+	QTimer *			m_tmrLoad;
+	QThreadPool *		m_loadPool;
+	QAtomicInt			m_loadGen;
+
 };
 
 #endif /* PROFILE_VIEW_HPP_ */
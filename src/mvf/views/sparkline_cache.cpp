@@ -0,0 +1,253 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDesktopServices>
+#include <QDir>
+#include <QMutexLocker>
+#include <QStringList>
+
+#include <boost/bind.hpp>
+
+#include "mvf/views/profile_cache.hpp"
+#include "mvf/views/profile_plot.hpp"
+#include "workers/sparklineworker.hpp"
+
+#include "sparkline_cache.hpp"
+
+//! Thumbnail Size in Pixels
+#define SPARKLINE_WIDTH		96
+#define SPARKLINE_HEIGHT	20
+
+//! In-Memory Cache Budget in Kilobytes
+#define SPARKLINE_CACHE_KB	4096
+
+SparklineCache * SparklineCache::m_instance = 0;
+
+SparklineCache::SparklineCache(QObject * parent)
+	: QObject(parent), m_mutex(), m_images(), m_pending(), m_serial(0), m_diskPath(),
+	  m_pool(0), m_session(0)
+{
+	m_images.setMaxCost(SPARKLINE_CACHE_KB);
+
+	m_pool = new QThreadPool(this);
+	m_pool->setMaxThreadCount(1);
+}
+
+SparklineCache::~SparklineCache()
+{
+	if (m_evtInserted.connected())
+		m_evtInserted.disconnect();
+	if (m_evtUpdated.connected())
+		m_evtUpdated.disconnect();
+	if (m_evtDeleted.connected())
+		m_evtDeleted.disconnect();
+
+	m_pool->waitForDone();
+
+	if (m_instance == this)
+		m_instance = 0;
+}
+
+SparklineCache * SparklineCache::Instance()
+{
+	/*
+	 * NB: The instance should be created from the GUI thread (see main())
+	 * before any worker threads are started.
+	 */
+	if (! m_instance)
+		m_instance = new SparklineCache(QCoreApplication::instance());
+
+	return m_instance;
+}
+
+void SparklineCache::attach(Session::Ptr session)
+{
+	if (! session || (session.get() == m_session))
+		return;
+
+	if (m_evtInserted.connected())
+		m_evtInserted.disconnect();
+	if (m_evtUpdated.connected())
+		m_evtUpdated.disconnect();
+	if (m_evtDeleted.connected())
+		m_evtDeleted.disconnect();
+
+	// Dive identifiers are only unique within a Session
+	clear();
+
+	m_session = session.get();
+	m_evtInserted = session->mapper<Profile>()->events().after_insert.connect(boost::bind(& SparklineCache::profileChanged, this, _1, _2));
+	m_evtUpdated = session->mapper<Profile>()->events().after_update.connect(boost::bind(& SparklineCache::profileChanged, this, _1, _2));
+	m_evtDeleted = session->mapper<Profile>()->events().before_delete.connect(boost::bind(& SparklineCache::profileChanged, this, _1, _2));
+}
+
+QString SparklineCache::cacheFile(const QString & diskPath, Profile::Ptr profile)
+{
+	if (diskPath.isEmpty())
+		return QString();
+
+	qlonglong stamp = profile->imported() ? (qlonglong)profile->imported().get() : 0;
+	return QString("%1/%2-%3-%4x%5.png")
+		.arg(diskPath)
+		.arg((qlonglong)profile->id())
+		.arg(stamp)
+		.arg(SPARKLINE_WIDTH)
+		.arg(SPARKLINE_HEIGHT);
+}
+
+void SparklineCache::clear()
+{
+	QMutexLocker lock(& m_mutex);
+	m_images.clear();
+	m_pending.clear();
+}
+
+void SparklineCache::invalidate(Dive::Ptr dive)
+{
+	if (! dive)
+		return;
+
+	{
+		QMutexLocker lock(& m_mutex);
+		m_images.remove(dive->id());
+		m_pending.remove(dive->id());
+	}
+
+	// Repaint so that the Views request a new Thumbnail
+	emit thumbnailReady(dive->id());
+}
+
+void SparklineCache::onRendered(qlonglong dive_id, int serial, const QImage & image)
+{
+	{
+		QMutexLocker lock(& m_mutex);
+
+		// Drop Images for Requests superseded by an Invalidation
+		if (m_pending.value(dive_id, -1) != serial)
+			return;
+
+		m_pending.remove(dive_id);
+		m_images.insert(dive_id, new QImage(image), (image.byteCount() + 1023) / 1024 + 1);
+	}
+
+	emit thumbnailReady(dive_id);
+}
+
+void SparklineCache::profileChanged(AbstractMapper::Ptr, Persistent::Ptr obj)
+{
+	Profile::Ptr p = boost::dynamic_pointer_cast<Profile>(obj);
+	if (! p)
+		return;
+
+	invalidate(p->dive());
+
+	/*
+	 * Remove the Profile's Images from the Disk Cache, since it may have been
+	 * changed without changing its Import Stamp
+	 */
+	QString path;
+	{
+		QMutexLocker lock(& m_mutex);
+		path = m_diskPath;
+	}
+
+	if (path.isEmpty())
+		return;
+
+	QDir dir(path);
+	QStringList files = dir.entryList(QStringList() << QString("%1-*.png").arg((qlonglong)p->id()), QDir::Files);
+	for (int i = 0; i < files.size(); ++i)
+		dir.remove(files.at(i));
+}
+
+void SparklineCache::setLogbook(const QString & path)
+{
+	clear();
+
+	QMutexLocker lock(& m_mutex);
+	if (path.isEmpty())
+	{
+		m_diskPath.clear();
+		return;
+	}
+
+	QByteArray hash = QCryptographicHash::hash(QDir(path).absolutePath().toUtf8(), QCryptographicHash::Md5);
+	m_diskPath = QString("%1/sparklines/%2")
+		.arg(QDesktopServices::storageLocation(QDesktopServices::CacheLocation))
+		.arg(QString(hash.toHex().left(16)));
+}
+
+bool SparklineCache::thumbnail(Dive::Ptr dive, QImage & image)
+{
+	if (! dive)
+		return false;
+
+	attach(dive->session());
+
+	QString path;
+	{
+		QMutexLocker lock(& m_mutex);
+		QImage * img = m_images.object(dive->id());
+		if (img)
+		{
+			image = * img;
+			return true;
+		}
+
+		if (m_pending.contains(dive->id()))
+			return false;
+
+		path = m_diskPath;
+	}
+
+	/*
+	 * Resolve the Default Profile here since the Session may only be used
+	 * from the GUI thread.  Dives without a Profile are cached as a null
+	 * image without queuing a render.
+	 */
+	std::vector<Profile::Ptr> profiles = ProfileCache::Instance()->profiles(dive, false);
+	Profile::Ptr profile = ProfilePlotView::defaultProfile(dive, profiles);
+
+	QMutexLocker lock(& m_mutex);
+	if (! profile)
+	{
+		m_images.insert(dive->id(), new QImage(), 1);
+		image = QImage();
+		return true;
+	}
+
+	int serial = ++m_serial;
+	m_pending.insert(dive->id(), serial);
+
+	SparklineWorker * worker = new SparklineWorker(dive->id(), profile, thumbnailSize(), cacheFile(path, profile), serial);
+	connect(worker, SIGNAL(rendered(qlonglong, int, const QImage &)), this, SLOT(onRendered(qlonglong, int, const QImage &)), Qt::QueuedConnection);
+	m_pool->start(worker);
+
+	return false;
+}
+
+QSize SparklineCache::thumbnailSize()
+{
+	return QSize(SPARKLINE_WIDTH, SPARKLINE_HEIGHT);
+}
@@ -0,0 +1,179 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef SPARKLINE_CACHE_HPP_
+#define SPARKLINE_CACHE_HPP_
+
+/**
+ * @file src/mvf/views/sparkline_cache.hpp
+ * @brief Profile Sparkline Cache Class
+ * @author Jonathan Krauss <jkrauss@asymworks.com>
+ */
+
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QSize>
+#include <QString>
+#include <QThreadPool>
+
+#include <boost/signals2.hpp>
+
+/*
+ * FIX for broken Qt4 moc and BOOST_JOIN error
+ */
+#ifdef Q_MOC_RUN
+#define BOOST_NO_TEMPLATE_PARTIAL_SPECIALIZATION
+#endif
+
+#include <benthos/logbook/dive.hpp>
+#include <benthos/logbook/mapper.hpp>
+#include <benthos/logbook/persistent.hpp>
+#include <benthos/logbook/profile.hpp>
+#include <benthos/logbook/session.hpp>
+using namespace benthos::logbook;
+
+/**
+ * @brief Profile Sparkline Cache
+ *
+ * Provides small depth-profile thumbnails for the dive list.  Thumbnails are
+ * rendered by a SparklineWorker on a background thread from the decimated
+ * depth data of each dive's default profile, so the item delegate only ever
+ * blits a finished image.  The default profile is resolved on the GUI thread
+ * before the render is queued, without pinning the profile list in the
+ * ProfileCache.  thumbnail() returns immediately; if the image is
+ * not ready it queues a render and the thumbnailReady() signal is emitted
+ * when it completes.
+ *
+ * Rendered images are kept in an in-memory LRU cache keyed by dive id, and
+ * are also written to an on-disk cache under the user's cache directory,
+ * keyed by profile id, import stamp and image size.  The disk cache is kept
+ * separately for each logbook file (see setLogbook()).
+ *
+ * Entries are invalidated when a Profile is inserted, updated or deleted
+ * through the logbook session.
+ */
+class SparklineCache: public QObject
+{
+	Q_OBJECT
+
+public:
+
+	//! @return Global Sparkline Cache Instance
+	static SparklineCache * Instance();
+
+	//! Class Destructor
+	virtual ~SparklineCache();
+
+public:
+
+	/**
+	 * @brief Get the Thumbnail for a Dive
+	 * @param[in] Dive
+	 * @param[out] Thumbnail Image (null if the dive has no depth profile)
+	 * @return If the Thumbnail is ready
+	 *
+	 * Queues a background render if the thumbnail is not cached.  Must be
+	 * called from the GUI thread.
+	 */
+	bool thumbnail(Dive::Ptr dive, QImage & image);
+
+	/**
+	 * @brief Invalidate the Thumbnail for a Dive
+	 * @param[in] Dive
+	 */
+	void invalidate(Dive::Ptr dive);
+
+	/**
+	 * @brief Set the current Logbook File
+	 * @param[in] Logbook File Path (empty to disable the disk cache)
+	 *
+	 * Clears the in-memory cache and selects the disk cache directory for the
+	 * logbook.
+	 */
+	void setLogbook(const QString & path);
+
+	//! @return Thumbnail Image Size
+	static QSize thumbnailSize();
+
+public slots:
+
+	//! @brief Clear all cached Thumbnails from Memory
+	void clear();
+
+signals:
+
+	/**
+	 * @brief Thumbnail Ready Signal
+	 * @param[out] Dive Identifier
+	 */
+	void thumbnailReady(qlonglong);
+
+protected:
+
+	//! Class Constructor
+	SparklineCache(QObject * parent = 0);
+
+	//! Attach to the Session's Profile Mapper Events
+	void attach(Session::Ptr session);
+
+	/**
+	 * @brief Get the Disk Cache File Name for a Profile
+	 * @param[in] Disk Cache Directory
+	 * @param[in] Profile
+	 * @return File Name (empty if the disk cache is disabled)
+	 */
+	static QString cacheFile(const QString & diskPath, Profile::Ptr profile);
+
+	//! Profile Mapper Event Handler
+	void profileChanged(AbstractMapper::Ptr, Persistent::Ptr);
+
+protected slots:
+
+	/**
+	 * @brief Store a Rendered Thumbnail
+	 * @param[in] Dive Identifier
+	 * @param[in] Serial Number of the Render Request
+	 * @param[in] Thumbnail Image
+	 */
+	void onRendered(qlonglong, int, const QImage &);
+
+private:
+	mutable QMutex						m_mutex;
+	QCache<qlonglong, QImage>			m_images;
+	QHash<qlonglong, int>				m_pending;
+	int									m_serial;
+	QString								m_diskPath;
+	QThreadPool *						m_pool;
+
+	Session *							m_session;
+	boost::signals2::connection			m_evtInserted;
+	boost::signals2::connection			m_evtUpdated;
+	boost::signals2::connection			m_evtDeleted;
+
+	static SparklineCache *				m_instance;
+
+};
+
+#endif /* SPARKLINE_CACHE_HPP_ */
@@ -0,0 +1,328 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <stdexcept>
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDesktopServices>
+#include <QDir>
+#include <QFile>
+
+#include <benthos/divecomputer/config.hpp>
+#include <benthos/divecomputer/driver.hpp>
+
+#include "devicecapture.hpp"
+
+//! Capture File Magic Number ('BXC1')
+#define CAPTURE_MAGIC			0x42584331
+
+//! Capture File Format Version
+#define CAPTURE_VERSION			1
+
+//! Smallest Stored Dive (data and token lengths, token count) in Bytes
+#define CAPTURE_DIVE_MIN		12
+
+//! Smallest Stored Parser Token (flags, index, value, name length) in Bytes
+#define CAPTURE_TOKEN_MIN		11
+
+//! Nominal Link Speed used to time Synthetic Transfers (bytes/s)
+#define SYNTHETIC_RATE			4800
+
+//! Sample Interval of Synthetic Dives (s)
+#define SYNTHETIC_INTERVAL		10
+
+//! Start Time of the first Synthetic Dive (2012-01-01 00:00 UTC)
+#define SYNTHETIC_EPOCH			1325376000
+
+//! Deterministic Linear Congruential Generator for Synthetic Dives
+static uint32_t next_random(uint32_t & state)
+{
+	state = state * 1103515245u + 12345u;
+	return (state >> 16) & 0x7fff;
+}
+
+static void add_token(capture_dive_t & dive, bool header, uint8_t token, int32_t value, uint8_t index = 0)
+{
+	capture_token_t t;
+	t.header = header;
+	t.token = token;
+	t.index = index;
+	t.value = value;
+	dive.tokens.push_back(t);
+
+	// Pack the Token into the synthetic Device Buffer
+	dive.data.push_back(token);
+	dive.data.push_back(index);
+	for (int i = 0; i < 4; ++i)
+		dive.data.push_back((uint8_t)(((uint32_t)value >> (8 * i)) & 0xff));
+}
+
+DeviceCapture::DeviceCapture()
+	: m_driver(), m_model(0), m_serial(0), m_ticks(0), m_transferMs(0), m_dives()
+{
+}
+
+DeviceCapture::~DeviceCapture()
+{
+}
+
+unsigned long DeviceCapture::bytes() const
+{
+	unsigned long ret = 0;
+	std::vector<capture_dive_t>::const_iterator it;
+	for (it = m_dives.begin(); it != m_dives.end(); it++)
+		ret += it->data.size();
+
+	return ret;
+}
+
+QString DeviceCapture::capturePath(const std::string & driver, const std::string & serial)
+{
+	QDir dir(QDesktopServices::storageLocation(QDesktopServices::DataLocation));
+	dir.mkpath("captures");
+
+	return dir.absoluteFilePath(QString("captures/%1-%2-%3.bxc")
+		.arg(QString::fromStdString(driver))
+		.arg(QString::fromStdString(serial))
+		.arg(QDateTime::currentDateTime().toString("yyyyMMdd-hhmmss")));
+}
+
+std::vector<capture_dive_t> & DeviceCapture::dives()
+{
+	return m_dives;
+}
+
+const std::vector<capture_dive_t> & DeviceCapture::dives() const
+{
+	return m_dives;
+}
+
+const std::string & DeviceCapture::driver() const
+{
+	return m_driver;
+}
+
+void DeviceCapture::load(const QString & path)
+{
+	QFile f(path);
+	if (! f.open(QIODevice::ReadOnly))
+		throw std::runtime_error(QString("Failed to open capture file '%1': %2")
+			.arg(path).arg(f.errorString()).toStdString());
+
+	QDataStream s(& f);
+	s.setVersion(QDataStream::Qt_4_6);
+
+	quint32 magic;
+	quint32 version;
+	s >> magic >> version;
+	if ((magic != CAPTURE_MAGIC) || (version != CAPTURE_VERSION))
+		throw std::runtime_error(QString("'%1' is not a supported capture file").arg(path).toStdString());
+
+	QByteArray driver;
+	quint8 model;
+	quint32 serial;
+	quint32 ticks;
+	qint64 transferMs;
+	quint32 ndives;
+	s >> driver >> model >> serial >> ticks >> transferMs >> ndives;
+
+	/*
+	 * The counts come from the file, so check them against the bytes left
+	 * before trusting them, and grow the lists one entry at a time so that a
+	 * corrupt count cannot allocate more than the file holds.
+	 */
+	bool corrupt = (ndives > (quint64)(f.size() - f.pos()) / CAPTURE_DIVE_MIN);
+
+	std::vector<capture_dive_t> dives;
+	for (quint32 i = 0; ! corrupt && (i < ndives) && (s.status() == QDataStream::Ok); ++i)
+	{
+		QByteArray data;
+		QByteArray token;
+		quint32 ntokens;
+		s >> data >> token >> ntokens;
+
+		if ((s.status() != QDataStream::Ok) || (ntokens > (quint64)(f.size() - f.pos()) / CAPTURE_TOKEN_MIN))
+		{
+			corrupt = true;
+			break;
+		}
+
+		dives.push_back(capture_dive_t());
+		capture_dive_t & dive = dives.back();
+		dive.data.assign(data.constData(), data.constData() + data.size());
+		dive.token.assign(token.constData(), token.size());
+
+		for (quint32 j = 0; (j < ntokens) && (s.status() == QDataStream::Ok); ++j)
+		{
+			capture_token_t t;
+			quint8 header;
+			qint32 value;
+			s >> header >> t.token >> t.index >> value >> t.name;
+
+			t.header = (header != 0);
+			t.value = value;
+			dive.tokens.push_back(t);
+		}
+	}
+
+	if (corrupt || (s.status() != QDataStream::Ok))
+		throw std::runtime_error(QString("Capture file '%1' is truncated or corrupt").arg(path).toStdString());
+
+	m_driver.assign(driver.constData(), driver.size());
+	m_model = model;
+	m_serial = serial;
+	m_ticks = ticks;
+	m_transferMs = transferMs;
+	m_dives.swap(dives);
+}
+
+uint8_t DeviceCapture::model() const
+{
+	return m_model;
+}
+
+void DeviceCapture::replay(size_t dive, capture_parse_fn header, capture_parse_fn profile, void * userdata) const
+{
+	if (dive >= m_dives.size())
+		return;
+
+	std::vector<capture_token_t>::const_iterator it;
+	for (it = m_dives[dive].tokens.begin(); it != m_dives[dive].tokens.end(); it++)
+	{
+		const char * name = it->name.isNull() ? NULL : it->name.constData();
+		(it->header ? header : profile)(userdata, it->token, it->value, it->index, name);
+	}
+}
+
+void DeviceCapture::save(const QString & path) const
+{
+	QFile f(path);
+	if (! f.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		throw std::runtime_error(QString("Failed to create capture file '%1': %2")
+			.arg(path).arg(f.errorString()).toStdString());
+
+	QDataStream s(& f);
+	s.setVersion(QDataStream::Qt_4_6);
+
+	s << (quint32)CAPTURE_MAGIC << (quint32)CAPTURE_VERSION;
+	s << QByteArray(m_driver.data(), m_driver.size()) << (quint8)m_model << (quint32)m_serial
+		<< (quint32)m_ticks << (qint64)m_transferMs << (quint32)m_dives.size();
+
+	std::vector<capture_dive_t>::const_iterator it;
+	for (it = m_dives.begin(); it != m_dives.end(); it++)
+	{
+		QByteArray data;
+		if (! it->data.empty())
+			data = QByteArray::fromRawData((const char *)& it->data[0], it->data.size());
+
+		s << data << QByteArray(it->token.data(), it->token.size()) << (quint32)it->tokens.size();
+
+		std::vector<capture_token_t>::const_iterator tit;
+		for (tit = it->tokens.begin(); tit != it->tokens.end(); tit++)
+			s << (quint8)(tit->header ? 1 : 0) << (quint8)tit->token << (quint8)tit->index << (qint32)tit->value << tit->name;
+	}
+
+	if (s.status() != QDataStream::Ok)
+		throw std::runtime_error(QString("Failed to write capture file '%1'").arg(path).toStdString());
+}
+
+uint32_t DeviceCapture::serial() const
+{
+	return m_serial;
+}
+
+void DeviceCapture::setDevice(const std::string & driver, uint8_t model, uint32_t serial, uint32_t ticks)
+{
+	m_driver = driver;
+	m_model = model;
+	m_serial = serial;
+	m_ticks = ticks;
+}
+
+void DeviceCapture::setTransferMs(qint64 value)
+{
+	m_transferMs = value;
+}
+
+void DeviceCapture::synthetic(unsigned int count, unsigned int seed)
+{
+	if (count > EMULATOR_SYNTHETIC_MAX)
+		count = EMULATOR_SYNTHETIC_MAX;
+
+	setDevice(EMULATOR_DRIVER, 0, seed, 0);
+	m_dives.clear();
+	m_dives.resize(count);
+
+	uint32_t state = seed;
+	for (unsigned int i = 0; i < count; ++i)
+	{
+		capture_dive_t & dive = m_dives[i];
+
+		// Square Profile: 18 m/min Descent and 9 m/min Ascent to a random Depth
+		int32_t duration = 30 + next_random(state) % 31;			// min
+		int32_t depth = 1000 + next_random(state) % 2000;			// cm
+		int32_t temp = 1500 + next_random(state) % 1000;			// 1/100 C
+		int32_t start = SYNTHETIC_EPOCH + i * 86400 + next_random(state) % 36000;
+
+		int32_t tdesc = depth * 60 / 1800;
+		int32_t tasc = depth * 60 / 900;
+		int32_t tend = duration * 60;
+
+		add_token(dive, true, DIVE_HEADER_START_TIME, start);
+		add_token(dive, true, DIVE_HEADER_DURATION, duration);
+		add_token(dive, true, DIVE_HEADER_MAX_DEPTH, depth);
+		add_token(dive, true, DIVE_HEADER_MIN_TEMP, temp);
+		add_token(dive, true, DIVE_HEADER_PX_START, 200000);
+		add_token(dive, true, DIVE_HEADER_PX_END, 50000);
+		add_token(dive, true, DIVE_HEADER_PMO2, 210);
+		add_token(dive, true, DIVE_HEADER_PMHe, 0);
+
+		for (int32_t t = 0; t <= tend; t += SYNTHETIC_INTERVAL)
+		{
+			int32_t d = depth;
+			if (t < tdesc)
+				d = depth * t / tdesc;
+			else if (t > tend - tasc)
+				d = depth * (tend - t) / tasc;
+
+			add_token(dive, false, DIVE_WAYPOINT_TIME, t);
+			add_token(dive, false, DIVE_WAYPOINT_DEPTH, d);
+			add_token(dive, false, DIVE_WAYPOINT_TEMP, temp);
+			add_token(dive, false, DIVE_WAYPOINT_PX, 200000 - 150000 * t / tend);
+		}
+
+		dive.token = QByteArray::number(start).constData();
+	}
+
+	m_transferMs = (qint64)bytes() * 1000 / SYNTHETIC_RATE;
+}
+
+uint32_t DeviceCapture::ticks() const
+{
+	return m_ticks;
+}
+
+qint64 DeviceCapture::transferMs() const
+{
+	return m_transferMs;
+}
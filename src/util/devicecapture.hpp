@@ -0,0 +1,188 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef DEVICECAPTURE_HPP_
+#define DEVICECAPTURE_HPP_
+
+/**
+ * @file src/util/devicecapture.hpp
+ * @brief Dive Computer Transfer Capture Class
+ * @author Jonathan Krauss <jkrauss@asymworks.com>
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <QByteArray>
+#include <QString>
+
+//! Driver Name of the Emulated Dive Computer
+#define EMULATOR_DRIVER			"emulator"
+
+//! Device Path Prefix for Synthetic Emulator Captures
+#define EMULATOR_SYNTHETIC		"synthetic:"
+
+//! Maximum Synthetic Dives (one per day from 2012 keeps start times in 32 bits)
+#define EMULATOR_SYNTHETIC_MAX	9500
+
+//! Driver Parser Callback (header and profile callbacks share a signature)
+typedef void (* capture_parse_fn)(void *, uint8_t, int32_t, uint8_t, const char *);
+
+/**
+ * @brief Captured Parser Token
+ *
+ * One call of the driver's header or profile parser callback.  A null name
+ * is kept distinct from an empty one, since the parser callbacks test it.
+ */
+typedef struct
+{
+	bool			header;
+	uint8_t			token;
+	uint8_t			index;
+	int32_t			value;
+	QByteArray		name;
+} capture_token_t;
+
+//! Captured Dive: Device Buffer, Transfer Token and Parser Tokens
+typedef struct
+{
+	std::vector<uint8_t>			data;
+	std::string						token;
+	std::vector<capture_token_t>	tokens;
+} capture_dive_t;
+
+/**
+ * @brief Dive Computer Transfer Capture
+ *
+ * Record of what a dive computer driver returned during a transfer: the
+ * device information passed to the device info callback, the dive buffers
+ * and tokens returned by the transfer, and the tokens the driver's parser
+ * produced for each dive.  Captures are written by the TransferWorker when
+ * asked to, and are replayed by the emulated dive computer (driver name
+ * EMULATOR_DRIVER), whose device path names the capture file.
+ *
+ * Since the parser tokens are stored, replaying a capture does not need the
+ * original driver, so transfer, parse and persist throughput can be measured
+ * without the hardware or its plugin.  Synthetic captures of any size can be
+ * generated with synthetic() for the same purpose.
+ *
+ * Capture files are written with QDataStream and start with a magic number
+ * and format version.
+ */
+class DeviceCapture
+{
+public:
+
+	//! Class Constructor
+	DeviceCapture();
+
+	//! Class Destructor
+	~DeviceCapture();
+
+public:
+
+	/**
+	 * @brief Load a Capture File
+	 * @param[in] File Path
+	 * @throws std::runtime_error if the file cannot be read
+	 */
+	void load(const QString & path);
+
+	/**
+	 * @brief Save the Capture to a File
+	 * @param[in] File Path
+	 * @throws std::runtime_error if the file cannot be written
+	 */
+	void save(const QString & path) const;
+
+	/**
+	 * @brief Replace the Capture with Synthetic Dives
+	 * @param[in] Number of Dives
+	 * @param[in] Random Seed (the same seed yields the same dives)
+	 *
+	 * Generates square-profile dives on air, one per day, and sets the serial
+	 * number to the seed.  The transfer time is that of a slow serial link.
+	 * The count is clamped to EMULATOR_SYNTHETIC_MAX.
+	 */
+	void synthetic(unsigned int count, unsigned int seed = 1);
+
+	/**
+	 * @brief Replay the Parser Tokens of a Dive
+	 * @param[in] Dive Index
+	 * @param[in] Header Callback
+	 * @param[in] Profile Callback
+	 * @param[in] Callback User Data
+	 */
+	void replay(size_t dive, capture_parse_fn header, capture_parse_fn profile, void * userdata) const;
+
+	//! @return Total Size of the Dive Buffers in Bytes
+	unsigned long bytes() const;
+
+	/**
+	 * @brief Build a new Capture File Path for a Dive Computer
+	 * @param[in] Driver Name
+	 * @param[in] Serial Number
+	 * @return Time-stamped Path in the captures/ Data Directory
+	 */
+	static QString capturePath(const std::string & driver, const std::string & serial);
+
+public:
+
+	//! @return Captured Dives
+	std::vector<capture_dive_t> & dives();
+
+	//! @return Captured Dives
+	const std::vector<capture_dive_t> & dives() const;
+
+	//! @return Driver Name of the Captured Device
+	const std::string & driver() const;
+
+	//! @return Device Model Number
+	uint8_t model() const;
+
+	//! @return Device Serial Number
+	uint32_t serial() const;
+
+	//! @return Device Clock Ticks
+	uint32_t ticks() const;
+
+	//! @return Data Transfer Time of the Captured Transfer (ms)
+	qint64 transferMs() const;
+
+	//! Set the Device Information
+	void setDevice(const std::string & driver, uint8_t model, uint32_t serial, uint32_t ticks);
+
+	//! Set the Data Transfer Time (ms)
+	void setTransferMs(qint64 value);
+
+private:
+	std::string						m_driver;
+	uint8_t							m_model;
+	uint32_t						m_serial;
+	uint32_t						m_ticks;
+	qint64							m_transferMs;
+	std::vector<capture_dive_t>		m_dives;
+
+};
+
+#endif /* DEVICECAPTURE_HPP_ */
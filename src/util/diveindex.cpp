@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <stdexcept>
+
+#include <QCryptographicHash>
+#include <QDataStream>
+
+#include "diveindex.hpp"
+#include "rawprofile.hpp"
+
+//! @return Check Value of Device Data from its Size and CRC-16
+static quint64 check_value(size_t size, quint16 crc)
+{
+	return ((quint64)size << 16) | crc;
+}
+
+DiveIndex::DiveIndex()
+	: m_profiles(), m_keys()
+{
+}
+
+DiveIndex::~DiveIndex()
+{
+}
+
+void DiveIndex::build(Session::Ptr session, DiveComputer::Ptr dc)
+{
+	clear();
+	if (! session || ! dc)
+		return;
+
+	IProfileFinder::Ptr pf = boost::dynamic_pointer_cast<IProfileFinder>(session->finder<Profile>());
+	if (! pf)
+		throw std::runtime_error("Failed to obtain IProfileFinder");
+
+	std::vector<Profile::Ptr> profiles = pf->findByComputer(dc->id());
+	m_profiles.reserve(profiles.size());
+
+	std::vector<Profile::Ptr>::const_iterator it;
+	for (it = profiles.begin(); it != profiles.end(); it++)
+	{
+		size_t size;
+		quint16 crc;
+		rawProfileChecksum((* it)->raw_profile(), size, crc);
+		if (size)
+			m_profiles.insert(check_value(size, crc), * it);
+	}
+}
+
+void DiveIndex::clear()
+{
+	m_profiles.clear();
+	m_keys.clear();
+}
+
+bool DiveIndex::contains(const QByteArray & key) const
+{
+	if (key.size() < (int)sizeof(quint64))
+		return false;
+
+	quint64 check;
+	QDataStream s(key);
+	s >> check;
+
+	// Digest only the Profiles with the same Size and CRC-16
+	QMultiHash<quint64, Profile::Ptr>::const_iterator it = m_profiles.constFind(check);
+	for ( ; (it != m_profiles.constEnd()) && (it.key() == check); ++it)
+		if (DiveIndex::key(decompressRawProfile(it.value()->raw_profile())) == key)
+			return true;
+
+	return false;
+}
+
+bool DiveIndex::insert(const QByteArray & key)
+{
+	if (key.isEmpty())
+		return true;
+
+	if (m_keys.contains(key))
+		return false;
+
+	m_keys.insert(key);
+	return true;
+}
+
+QByteArray DiveIndex::key(const std::vector<uint8_t> & raw)
+{
+	if (raw.empty())
+		return QByteArray();
+
+	QByteArray data = QByteArray::fromRawData((const char *)& raw[0], raw.size());
+
+	QByteArray k;
+	QDataStream s(& k, QIODevice::WriteOnly);
+	s << check_value(raw.size(), qChecksum(data.constData(), data.size()));
+
+	k.append(QCryptographicHash::hash(data, QCryptographicHash::Sha1));
+	return k;
+}
+
+int DiveIndex::size() const
+{
+	return m_profiles.size() + m_keys.size();
+}
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef DIVEINDEX_HPP_
+#define DIVEINDEX_HPP_
+
+/**
+ * @file src/util/diveindex.hpp
+ * @brief Duplicate Dive Index Class
+ * @author Jonathan Krauss <jkrauss@asymworks.com>
+ */
+
+#include <cstdint>
+#include <vector>
+
+#include <QByteArray>
+#include <QMultiHash>
+#include <QSet>
+
+/*
+ * FIX for broken Qt4 moc and BOOST_JOIN error
+ */
+#ifdef Q_MOC_RUN
+#define BOOST_NO_TEMPLATE_PARTIAL_SPECIALIZATION
+#endif
+
+#include <benthos/logbook/dive_computer.hpp>
+#include <benthos/logbook/profile.hpp>
+#include <benthos/logbook/session.hpp>
+using namespace benthos::logbook;
+
+/**
+ * @brief Duplicate Dive Index
+ *
+ * Index of the profiles a dive computer already has in a logbook, used to
+ * drop re-transferred dives.  A dive is identified by its device data: the
+ * key holds the size and CRC-16 of the data followed by its SHA-1 digest.
+ *
+ * Building the index runs a single profile query and reads only the size and
+ * CRC-16 of each profile, which packed raw profiles store in their header, so
+ * no dive is loaded and nothing is decompressed or digested.  A transferred
+ * dive is only compared by SHA-1 with the existing profiles whose size and
+ * CRC-16 match it.  Dives added during the transfer are held in a separate
+ * set of full keys, so dives repeated within the transfer are found too.
+ *
+ * Profiles without raw data are not indexed.
+ */
+class DiveIndex
+{
+public:
+
+	//! Class Constructor
+	DiveIndex();
+
+	//! Class Destructor
+	~DiveIndex();
+
+public:
+
+	/**
+	 * @brief Build the Index from a Logbook
+	 * @param[in] Logbook Session
+	 * @param[in] Dive Computer
+	 *
+	 * Queries the session, so must be called from the GUI thread.
+	 */
+	void build(Session::Ptr session, DiveComputer::Ptr dc);
+
+	//! Clear the Index
+	void clear();
+
+	/**
+	 * @brief Check if a Dive is already in the Logbook
+	 * @param[in] Key from key()
+	 * @return If an indexed Profile has the same Device Data
+	 *
+	 * Only reads the index built by build(), so may be called from several
+	 * threads at once while no other method is running.
+	 */
+	bool contains(const QByteArray & key) const;
+
+	/**
+	 * @brief Add a Transferred Dive to the Index
+	 * @param[in] Key from key()
+	 * @return False if the Key was already added
+	 *
+	 * Empty keys are never considered duplicates.
+	 */
+	bool insert(const QByteArray & key);
+
+	/**
+	 * @brief Build the Index Key from Uncompressed Device Data
+	 * @param[in] Raw Profile Data
+	 * @return Key, or an empty array if there is no raw data
+	 */
+	static QByteArray key(const std::vector<uint8_t> & raw);
+
+	//! @return Number of Indexed Profiles and Dives
+	int size() const;
+
+private:
+	QMultiHash<quint64, Profile::Ptr>	m_profiles;
+	QSet<QByteArray>					m_keys;
+
+};
+
+#endif /* DIVEINDEX_HPP_ */
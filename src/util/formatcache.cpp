@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <stdexcept>
+
+#include <QCoreApplication>
+#include <QMutexLocker>
+#include <QSettings>
+
+#include "formatcache.hpp"
+
+FormatCache * FormatCache::m_instance = 0;
+
+FormatCache::FormatCache(QObject * parent)
+	: QObject(parent), m_mutex(), m_strings(2048), m_units(), m_dtformat()
+{
+}
+
+FormatCache::~FormatCache()
+{
+	if (m_instance == this)
+		m_instance = 0;
+}
+
+FormatCache * FormatCache::Instance()
+{
+	/*
+	 * NB: The instance should be created from the GUI thread (see main())
+	 * before any worker threads are started.
+	 */
+	if (! m_instance)
+	{
+		m_instance = new FormatCache(QCoreApplication::instance());
+		if (QCoreApplication::instance())
+			QCoreApplication::instance()->installEventFilter(m_instance);
+	}
+
+	return m_instance;
+}
+
+QString FormatCache::dateTimeFormat()
+{
+	QMutexLocker lock(& m_mutex);
+	if (m_dtformat.isNull())
+	{
+		QSettings s;
+		s.beginGroup("Settings");
+		m_dtformat = s.value(QString("DTFormat"), QString("MM/dd/yy hh:mm AP")).toString();
+		s.endGroup();
+	}
+
+	return m_dtformat;
+}
+
+bool FormatCache::eventFilter(QObject * obj, QEvent * event)
+{
+	if ((event->type() == QEvent::LocaleChange) && (obj == QCoreApplication::instance()))
+		invalidate();
+
+	return QObject::eventFilter(obj, event);
+}
+
+QString FormatCache::format(const char * formatter, const QVariant & value, formatter_fn fn)
+{
+	if (value.isNull())
+		return fn(value);
+
+	QString key = QString("%1\x1f%2").arg(formatter).arg(value.toString());
+
+	{
+		QMutexLocker lock(& m_mutex);
+		QString * cached = m_strings.object(key);
+		if (cached)
+			return * cached;
+	}
+
+	QString result = fn(value);
+
+	QMutexLocker lock(& m_mutex);
+	m_strings.insert(key, new QString(result));
+	return result;
+}
+
+void FormatCache::invalidate()
+{
+	{
+		QMutexLocker lock(& m_mutex);
+		m_strings.clear();
+		m_units.clear();
+		m_dtformat = QString();
+	}
+
+	emit invalidated();
+}
+
+int FormatCache::maxEntries() const
+{
+	QMutexLocker lock(& m_mutex);
+	return m_strings.maxCost();
+}
+
+void FormatCache::setMaxEntries(int value)
+{
+	QMutexLocker lock(& m_mutex);
+	m_strings.setMaxCost(value);
+}
+
+unit_t FormatCache::unit(quantity_t q, const char * _default)
+{
+	QString key = QString("%1\x1f%2").arg(q).arg(_default ? _default : "");
+
+	QMutexLocker lock(& m_mutex);
+	QHash<QString, unit_t>::const_iterator it = m_units.find(key);
+	if (it != m_units.end())
+		return it.value();
+
+	QSettings s;
+	s.beginGroup("Settings");
+	QVariant uname = s.value(QString("Unit%1").arg(q));
+	s.endGroup();
+
+	unit_t u;
+	if (! uname.isValid())
+		u = findUnit(q, _default);
+	else
+		u = findUnit(q, (const char *)uname.toByteArray());
+
+	m_units.insert(key, u);
+	return u;
+}
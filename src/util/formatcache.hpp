@@ -0,0 +1,133 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef FORMATCACHE_HPP_
+#define FORMATCACHE_HPP_
+
+/**
+ * @file src/util/formatcache.hpp
+ * @brief Display Text Formatting Cache
+ * @author Jonathan Krauss <jkrauss@asymworks.com>
+ */
+
+#include <QCache>
+#include <QEvent>
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QVariant>
+
+#include "units.hpp"
+
+/**
+ * @brief Display Text Formatting Cache
+ *
+ * Bounded memoization cache which maps a (formatter, input value) pair to the
+ * formatted display string.  Item delegates and plot labels call format()
+ * with a formatter name and a function pointer which is only invoked when the
+ * value is not already in the cache.  The cache also holds the display
+ * settings which the formatters depend on (the date/time format string and the
+ * selected unit for each quantity) so that they are not re-read from
+ * QSettings for every cell.
+ *
+ * The cache is cleared when the application locale changes or when
+ * invalidate() is called after the display settings have been modified.  The
+ * invalidated() signal is emitted so that other caches holding formatted or
+ * unit-converted data can be flushed at the same time.
+ *
+ * All methods are thread-safe; the formatter function is called without the
+ * cache lock held.
+ */
+class FormatCache: public QObject
+{
+	Q_OBJECT
+
+public:
+
+	//! Formatter Function Type
+	typedef QString (* formatter_fn)(const QVariant &);
+
+	//! @return Global Format Cache Instance
+	static FormatCache * Instance();
+
+	//! Class Destructor
+	virtual ~FormatCache();
+
+public:
+
+	/**
+	 * @brief Format a Value
+	 * @param[in] Formatter Name
+	 * @param[in] Value to Format
+	 * @param[in] Formatter Function
+	 * @return Formatted String
+	 */
+	QString format(const char * formatter, const QVariant & value, formatter_fn fn);
+
+	//! @return Date/Time Display Format String
+	QString dateTimeFormat();
+
+	/**
+	 * @brief Look up the Display Unit for a Quantity
+	 * @param[in] Quantity
+	 * @param[in] Default Unit Name
+	 * @return Unit Record
+	 * @throws std::runtime_error if the unit is not registered
+	 */
+	unit_t unit(quantity_t quantity, const char * _default = 0);
+
+	//! @return Maximum Number of Cached Strings
+	int maxEntries() const;
+
+	//! @param[in] Maximum Number of Cached Strings
+	void setMaxEntries(int value);
+
+public slots:
+
+	//! @brief Clear all cached Strings and Settings
+	void invalidate();
+
+signals:
+
+	//! Emitted when the Cache has been invalidated
+	void invalidated();
+
+protected:
+
+	//! Class Constructor
+	FormatCache(QObject * parent = 0);
+
+	//! Watches for Locale Changes
+	virtual bool eventFilter(QObject * obj, QEvent * event);
+
+private:
+	mutable QMutex				m_mutex;
+	QCache<QString, QString>	m_strings;
+	QHash<QString, unit_t>		m_units;
+	QString						m_dtformat;
+
+	static FormatCache *		m_instance;
+
+};
+
+#endif /* FORMATCACHE_HPP_ */
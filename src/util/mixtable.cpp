@@ -0,0 +1,87 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+
+#include <vector>
+
+#include <QMutexLocker>
+
+#include "mixtable.hpp"
+
+//! @return Table Key for a Mix Composition
+static quint32 mix_key(unsigned int o2, unsigned int he)
+{
+	return ((quint32)(o2 & 0xffff) << 16) | (he & 0xffff);
+}
+
+MixTable::MixTable()
+	: m_lock(), m_mixes(), m_air()
+{
+}
+
+MixTable::~MixTable()
+{
+}
+
+Mix::Ptr MixTable::air() const
+{
+	QMutexLocker lock(& m_lock);
+	return m_air;
+}
+
+void MixTable::load(Session::Ptr session)
+{
+	QMutexLocker lock(& m_lock);
+	m_mixes.clear();
+	m_air.reset();
+
+	if (! session)
+		return;
+
+	std::vector<Mix::Ptr> mixes = session->finder<Mix>()->find();
+	std::vector<Mix::Ptr>::const_iterator it;
+	for (it = mixes.begin(); it != mixes.end(); it++)
+	{
+		quint32 key = mix_key((* it)->o2_permil(), (* it)->he_permil());
+		if (! m_mixes.contains(key))
+			m_mixes.insert(key, * it);
+
+		if (! m_air && (* it)->name() && ((* it)->name().get() == "Air"))
+			m_air = * it;
+	}
+}
+
+Mix::Ptr MixTable::resolve(Mix::Ptr mix)
+{
+	if (! mix)
+		return mix;
+
+	quint32 key = mix_key(mix->o2_permil(), mix->he_permil());
+
+	QMutexLocker lock(& m_lock);
+	QHash<quint32, Mix::Ptr>::const_iterator it = m_mixes.constFind(key);
+	if (it != m_mixes.constEnd())
+		return it.value();
+
+	m_mixes.insert(key, mix);
+	return mix;
+}
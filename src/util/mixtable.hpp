@@ -0,0 +1,104 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+
+#ifndef MIXTABLE_HPP_
+#define MIXTABLE_HPP_
+
+/**
+ * @file src/util/mixtable.hpp
+ * @brief Shared Gas Mix Table Class
+ * @author Jonathan Krauss <jkrauss@asymworks.com>
+ */
+
+#include <QHash>
+#include <QMutex>
+
+#include <boost/shared_ptr.hpp>
+
+/*
+ * FIX for broken Qt4 moc and BOOST_JOIN error
+ */
+#ifdef Q_MOC_RUN
+#define BOOST_NO_TEMPLATE_PARTIAL_SPECIALIZATION
+#endif
+
+#include <benthos/logbook/mix.hpp>
+#include <benthos/logbook/session.hpp>
+using namespace benthos::logbook;
+
+/**
+ * @brief Gas Mix Table
+ *
+ * Gas mixes keyed by their O2 and He fractions.  The table is loaded from the
+ * logbook on the GUI thread before a transfer starts, after which parse tasks
+ * resolve each mix they read against it without querying the database.  A
+ * mix first seen during a transfer is added to the table, so every dive that
+ * uses the same new gas shares a single Mix instance.
+ *
+ * One table may be shared by several TransferWorker instances that run at
+ * the same time, so that a new gas used on more than one computer is only
+ * added to the logbook once.  resolve() is thread-safe; load() is not and
+ * must be called before the table is shared.
+ */
+class MixTable
+{
+public:
+	typedef boost::shared_ptr<MixTable>	Ptr;
+
+public:
+
+	//! Class Constructor
+	MixTable();
+
+	//! Class Destructor
+	~MixTable();
+
+public:
+
+	//! @return Mix named "Air" in the Logbook, or an empty pointer
+	Mix::Ptr air() const;
+
+	/**
+	 * @brief Load the Gas Mixes from a Logbook
+	 * @param[in] Logbook Session
+	 *
+	 * Queries the session, so must be called from the GUI thread.
+	 */
+	void load(Session::Ptr session);
+
+	/**
+	 * @brief Resolve a Mix against the Table
+	 * @param[in] Mix read from a Dive
+	 * @return Mix with the same Composition already in the Table, or the
+	 * given Mix after adding it to the Table
+	 */
+	Mix::Ptr resolve(Mix::Ptr mix);
+
+private:
+	mutable QMutex				m_lock;
+	QHash<quint32, Mix::Ptr>	m_mixes;
+	Mix::Ptr					m_air;
+
+};
+
+#endif /* MIXTABLE_HPP_ */
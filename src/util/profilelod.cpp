@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <algorithm>
+
+#include "profilelod.hpp"
+
+//! Stop building Levels once a Level has this few Buckets
+#define LOD_MIN_BUCKETS		64
+
+ProfileLOD::ProfileLOD(const QVector<double> & keys, const QVector<double> & values)
+	: m_keys(keys), m_values(values), m_levels()
+{
+	int n = std::min(m_keys.size(), m_values.size());
+
+	/*
+	 * Level 1 is built from pairs of samples; each subsequent level is built
+	 * from pairs of buckets in the level below.
+	 */
+	int nb = n;
+	while (nb > LOD_MIN_BUCKETS)
+	{
+		int nprev = nb;
+		nb = (nprev + 1) / 2;
+
+		level_t lvl;
+		lvl.imin.resize(nb);
+		lvl.imax.resize(nb);
+
+		for (int j = 0; j < nb; ++j)
+		{
+			int a0, a1, b0, b1;
+			if (m_levels.empty())
+			{
+				a0 = a1 = 2 * j;
+				b0 = b1 = std::min(2 * j + 1, nprev - 1);
+			}
+			else
+			{
+				const level_t & prev = m_levels.back();
+				a0 = prev.imin[2 * j];
+				a1 = prev.imax[2 * j];
+				b0 = prev.imin[std::min(2 * j + 1, nprev - 1)];
+				b1 = prev.imax[std::min(2 * j + 1, nprev - 1)];
+			}
+
+			lvl.imin[j] = (m_values[b0] < m_values[a0]) ? b0 : a0;
+			lvl.imax[j] = (m_values[b1] > m_values[a1]) ? b1 : a1;
+		}
+
+		m_levels.push_back(lvl);
+	}
+}
+
+ProfileLOD::~ProfileLOD()
+{
+}
+
+void ProfileLOD::decimate(double lower, double upper, int pixels, QVector<double> & keys, QVector<double> & values) const
+{
+	keys.clear();
+	values.clear();
+
+	int n = size();
+	if (n == 0)
+		return;
+
+	/*
+	 * Find the Sample Range, including one Sample on either side
+	 */
+	int i0 = std::lower_bound(m_keys.begin(), m_keys.begin() + n, lower) - m_keys.begin();
+	int i1 = std::upper_bound(m_keys.begin(), m_keys.begin() + n, upper) - m_keys.begin();
+	if (i0 > 0)
+		--i0;
+	if (i1 < n)
+		++i1;
+
+	if (i1 <= i0)
+		return;
+
+	/*
+	 * Choose the coarsest Level with at least one Bucket per Pixel
+	 */
+	int count = i1 - i0;
+	int k = 0;
+	if (pixels > 0)
+		while ((k < (int)m_levels.size()) && ((count >> (k + 1)) >= pixels))
+			++k;
+
+	if (k == 0)
+	{
+		keys = m_keys.mid(i0, count);
+		values = m_values.mid(i0, count);
+		return;
+	}
+
+	/*
+	 * Emit the Min/Max Samples of each Bucket in Key Order
+	 */
+	const level_t & lvl = m_levels[k - 1];
+	int j0 = i0 >> k;
+	int j1 = (i1 - 1) >> k;
+
+	keys.reserve((j1 - j0 + 1) * 2);
+	values.reserve((j1 - j0 + 1) * 2);
+
+	for (int j = j0; j <= j1; ++j)
+	{
+		int a = std::min(lvl.imin[j], lvl.imax[j]);
+		int b = std::max(lvl.imin[j], lvl.imax[j]);
+
+		keys.push_back(m_keys[a]);
+		values.push_back(m_values[a]);
+
+		if (b != a)
+		{
+			keys.push_back(m_keys[b]);
+			values.push_back(m_values[b]);
+		}
+	}
+}
+
+const QVector<double> & ProfileLOD::keys() const
+{
+	return m_keys;
+}
+
+int ProfileLOD::levels() const
+{
+	return (int)m_levels.size();
+}
+
+size_t ProfileLOD::memoryUsage() const
+{
+	size_t n = sizeof(ProfileLOD);
+
+	std::vector<level_t>::const_iterator it;
+	for (it = m_levels.begin(); it != m_levels.end(); it++)
+		n += (it->imin.capacity() + it->imax.capacity()) * sizeof(int);
+
+	return n;
+}
+
+int ProfileLOD::size() const
+{
+	return std::min(m_keys.size(), m_values.size());
+}
+
+const QVector<double> & ProfileLOD::values() const
+{
+	return m_values;
+}
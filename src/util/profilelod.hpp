@@ -0,0 +1,114 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef PROFILELOD_HPP_
+#define PROFILELOD_HPP_
+
+/**
+ * @file src/util/profilelod.hpp
+ * @brief Profile Level-of-Detail Class
+ * @author Jonathan Krauss <jkrauss@asymworks.com>
+ */
+
+#include <vector>
+
+#include <QVector>
+
+#include <boost/shared_ptr.hpp>
+
+/**
+ * @brief Min/Max Level-of-Detail Pyramid for a Data Series
+ *
+ * Decimates a (key, value) series with sorted keys for plotting.  Level k of
+ * the pyramid divides the samples into buckets of 2^k samples and stores the
+ * index of the minimum and maximum value in each bucket.  The pyramid is
+ * built once per series; decimate() then picks the coarsest level which
+ * still has at least one bucket per pixel column over the requested key range
+ * and returns the minimum and maximum sample of each bucket in key order.
+ * This bounds the number of points plotted to about twice the plot width
+ * while preserving the visual envelope of the series.
+ *
+ * The source vectors are implicitly shared, so keeping a ProfileLOD alongside
+ * the full-resolution data does not copy it.
+ */
+class ProfileLOD
+{
+public:
+	typedef boost::shared_ptr<ProfileLOD>	Ptr;
+
+public:
+
+	/**
+	 * @brief Class Constructor
+	 * @param[in] Keys (sorted ascending)
+	 * @param[in] Values
+	 */
+	ProfileLOD(const QVector<double> & keys, const QVector<double> & values);
+
+	//! Class Destructor
+	~ProfileLOD();
+
+public:
+
+	/**
+	 * @brief Decimate the Series for a Key Range
+	 * @param[in] Lower Key Bound
+	 * @param[in] Upper Key Bound
+	 * @param[in] Number of Pixel Columns spanning the Range
+	 * @param[out] Decimated Keys
+	 * @param[out] Decimated Values
+	 *
+	 * One sample on either side of the range is included so that lines reach
+	 * the edges of the plot.
+	 */
+	void decimate(double lower, double upper, int pixels, QVector<double> & keys, QVector<double> & values) const;
+
+	//! @return Full-Resolution Keys
+	const QVector<double> & keys() const;
+
+	//! @return Number of Pyramid Levels (excluding the full-resolution data)
+	int levels() const;
+
+	//! @return Approximate Memory Footprint of the Pyramid in Bytes
+	size_t memoryUsage() const;
+
+	//! @return Number of Samples
+	int size() const;
+
+	//! @return Full-Resolution Values
+	const QVector<double> & values() const;
+
+private:
+	typedef struct
+	{
+		std::vector<int>	imin;
+		std::vector<int>	imax;
+	} level_t;
+
+private:
+	QVector<double>			m_keys;
+	QVector<double>			m_values;
+	std::vector<level_t>	m_levels;
+
+};
+
+#endif /* PROFILELOD_HPP_ */
@@ -0,0 +1,164 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "profileseries.hpp"
+
+struct alarm_compare_times
+{
+	bool operator()(const alarm_event_t & lhs, const alarm_event_t & rhs) const
+	{
+		return (lhs.time < rhs.time);
+	}
+};
+
+ProfileSeries::ProfileSeries()
+	: m_time(), m_mixes(), m_channels(), m_alarms()
+{
+}
+
+ProfileSeries::ProfileSeries(const std::list<waypoint> & profile)
+	: m_time(), m_mixes(), m_channels(), m_alarms()
+{
+	size_t n = profile.size();
+	m_time.reserve(n);
+	m_mixes.reserve(n);
+
+	size_t i = 0;
+	std::list<waypoint>::const_iterator it;
+	for (it = profile.begin(); it != profile.end(); it++, i++)
+	{
+		m_time.push_back(it->time);
+		m_mixes.push_back(it->mix);
+
+		std::map<std::string, double>::const_iterator dit;
+		for (dit = it->data.begin(); dit != it->data.end(); dit++)
+		{
+			channel_map_t::iterator cit = m_channels.find(dit->first);
+			if (cit == m_channels.end())
+			{
+				cit = m_channels.insert(std::pair<std::string, channel_data>(dit->first, channel_data())).first;
+				cit->second.values.resize(n, 0.0);
+				cit->second.present.resize(n, 0);
+			}
+
+			cit->second.values[i] = dit->second;
+			cit->second.present[i] = 1;
+		}
+
+		std::set<std::string>::const_iterator ait;
+		for (ait = it->alarms.begin(); ait != it->alarms.end(); ait++)
+		{
+			alarm_event_t e;
+			e.index = i;
+			e.time = it->time;
+			e.name = * ait;
+			m_alarms.push_back(e);
+		}
+	}
+
+	std::stable_sort(m_alarms.begin(), m_alarms.end(), alarm_compare_times());
+}
+
+ProfileSeries::~ProfileSeries()
+{
+}
+
+const std::vector<alarm_event_t> & ProfileSeries::alarms() const
+{
+	return m_alarms;
+}
+
+ProfileSeries::Ptr ProfileSeries::Build(Profile::Ptr profile)
+{
+	if (! profile || profile->profile().empty())
+		return Ptr();
+
+	return Ptr(new ProfileSeries(profile->profile()));
+}
+
+const std::vector<double> & ProfileSeries::channel(const std::string & key) const
+{
+	return m_channels.at(key).values;
+}
+
+bool ProfileSeries::empty() const
+{
+	return m_time.empty();
+}
+
+bool ProfileSeries::hasChannel(const std::string & key) const
+{
+	return (m_channels.find(key) != m_channels.end());
+}
+
+std::set<std::string> ProfileSeries::keys() const
+{
+	std::set<std::string> result;
+	channel_map_t::const_iterator it;
+	for (it = m_channels.begin(); it != m_channels.end(); it++)
+		result.insert(it->first);
+
+	return result;
+}
+
+size_t ProfileSeries::lowerBound(double time) const
+{
+	return std::lower_bound(m_time.begin(), m_time.end(), time) - m_time.begin();
+}
+
+const std::vector<uint8_t> & ProfileSeries::mask(const std::string & key) const
+{
+	return m_channels.at(key).present;
+}
+
+size_t ProfileSeries::memoryUsage() const
+{
+	size_t n = m_time.capacity() * sizeof(double) + m_mixes.capacity() * sizeof(Mix::Ptr);
+
+	channel_map_t::const_iterator it;
+	for (it = m_channels.begin(); it != m_channels.end(); it++)
+		n += it->second.values.capacity() * sizeof(double) + it->second.present.capacity();
+
+	std::vector<alarm_event_t>::const_iterator ait;
+	for (ait = m_alarms.begin(); ait != m_alarms.end(); ait++)
+		n += sizeof(alarm_event_t) + ait->name.capacity();
+
+	return n + sizeof(ProfileSeries);
+}
+
+const std::vector<Mix::Ptr> & ProfileSeries::mixes() const
+{
+	return m_mixes;
+}
+
+size_t ProfileSeries::size() const
+{
+	return m_time.size();
+}
+
+const std::vector<double> & ProfileSeries::time() const
+{
+	return m_time;
+}
@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef PROFILESERIES_HPP_
+#define PROFILESERIES_HPP_
+
+/**
+ * @file src/util/profileseries.hpp
+ * @brief Columnar Profile Data Class
+ * @author Jonathan Krauss <jkrauss@asymworks.com>
+ */
+
+#include <cstdint>
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+/*
+ * FIX for broken Qt4 moc and BOOST_JOIN error
+ */
+#ifdef Q_MOC_RUN
+#define BOOST_NO_TEMPLATE_PARTIAL_SPECIALIZATION
+#endif
+
+#include <benthos/logbook/mix.hpp>
+#include <benthos/logbook/profile.hpp>
+using namespace benthos::logbook;
+
+/**
+ * @brief Profile Alarm Event Record
+ */
+typedef struct
+{
+	size_t						index;
+	unsigned int				time;
+	std::string					name;
+} alarm_event_t;
+
+/**
+ * @brief Columnar (Structure-of-Arrays) Profile Data
+ *
+ * Derived representation of a Profile's waypoint list.  The waypoint times
+ * are stored in a single contiguous array, each data key (depth, temp, etc.)
+ * is stored as a dense array of values with a parallel presence mask, and
+ * the alarms are flattened into a list of events sorted by time.  Consumers
+ * look up a channel once by name and then walk plain arrays rather than doing
+ * a string-keyed map lookup for every waypoint.
+ *
+ * A ProfileSeries is built once from a Profile and is immutable afterwards,
+ * so it may be shared between threads.
+ */
+class ProfileSeries
+{
+public:
+	typedef boost::shared_ptr<ProfileSeries>	Ptr;
+
+public:
+
+	//! Class Constructor
+	ProfileSeries();
+
+	/**
+	 * @brief Class Constructor
+	 * @param[in] Waypoint List
+	 */
+	ProfileSeries(const std::list<waypoint> & profile);
+
+	//! Class Destructor
+	~ProfileSeries();
+
+	/**
+	 * @brief Build the Series for a Profile
+	 * @param[in] Profile
+	 * @return Profile Series, or an empty pointer if the profile is empty
+	 */
+	static Ptr Build(Profile::Ptr profile);
+
+public:
+
+	//! @return Alarm Events sorted by Time
+	const std::vector<alarm_event_t> & alarms() const;
+
+	/**
+	 * @brief Get the Values for a Channel
+	 * @param[in] Channel Key
+	 * @return Channel Values (zero where the sample is not present)
+	 * @throws std::out_of_range if the channel does not exist
+	 */
+	const std::vector<double> & channel(const std::string & key) const;
+
+	//! @return If the Series has no Samples
+	bool empty() const;
+
+	//! @return If the Series has the given Channel
+	bool hasChannel(const std::string & key) const;
+
+	//! @return Set of Channel Keys
+	std::set<std::string> keys() const;
+
+	/**
+	 * @brief Find the first Sample at or after a Time
+	 * @param[in] Time in Seconds
+	 * @return Sample Index (size() if past the end)
+	 */
+	size_t lowerBound(double time) const;
+
+	/**
+	 * @brief Get the Presence Mask for a Channel
+	 * @param[in] Channel Key
+	 * @return Presence Mask (non-zero where the sample has a value)
+	 * @throws std::out_of_range if the channel does not exist
+	 */
+	const std::vector<uint8_t> & mask(const std::string & key) const;
+
+	//! @return Approximate Memory Footprint in Bytes
+	size_t memoryUsage() const;
+
+	//! @return Gas Mix at each Sample
+	const std::vector<Mix::Ptr> & mixes() const;
+
+	//! @return Number of Samples
+	size_t size() const;
+
+	//! @return Sample Times in Seconds
+	const std::vector<double> & time() const;
+
+private:
+	typedef struct
+	{
+		std::vector<double>		values;
+		std::vector<uint8_t>	present;
+	} channel_data;
+
+	typedef std::map<std::string, channel_data>	channel_map_t;
+
+private:
+	std::vector<double>				m_time;
+	std::vector<Mix::Ptr>			m_mixes;
+	channel_map_t					m_channels;
+	std::vector<alarm_event_t>		m_alarms;
+
+};
+
+#endif /* PROFILESERIES_HPP_ */
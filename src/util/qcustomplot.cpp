@@ -176,6 +176,8 @@
 
 #include "qcustomplot.h"
 
+#include <algorithm>
+
 // ================================================================================
 // =================== QCPData
 // ================================================================================
@@ -220,6 +222,158 @@ QCPData::QCPData(double key, double value) :
 {
 }
 
+// ================================================================================
+// =================== QCPDataContainer
+// ================================================================================
+
+/*! \class QCPDataContainer
+  \brief Sorted, contiguous container for QCPData items.
+  
+  Stores the data points of a QCPGraph in a single array sorted by key, rather than in a
+  QMap with one heap node per point. Looking up the visible key range is a binary search
+  over contiguous memory, and \ref assign fills the container from key and value vectors
+  with a single allocation.
+  
+  The container provides the subset of the QMap interface which QCPGraph uses (iterators with
+  \a key() and \a value(), \ref lowerBound, \ref upperBound, \ref insertMulti, \ref erase,
+  \ref remove and \ref unite), so it is a drop-in replacement for the former QMap based
+  QCPDataMap. Points with equal keys are kept in insertion order, with the most recently
+  inserted point first, like QMap::insertMulti. Inserting a point in the middle of the
+  container is linear in the number of points; prefer \ref assign for bulk data.
+  
+  \see QCPData, QCPGraph::setData
+*/
+
+namespace {
+struct QCPDataKeyLess
+{
+  bool operator()(const QCPData &a, double b) const { return a.key < b; }
+  bool operator()(double a, const QCPData &b) const { return a < b.key; }
+  bool operator()(const QCPData &a, const QCPData &b) const { return a.key < b.key; }
+};
+}
+
+/*!
+  Returns an iterator to the first data point with a key not less than \a key.
+*/
+QCPDataContainer::iterator QCPDataContainer::lowerBound(double key)
+{
+  return iterator(std::lower_bound(begin().p, end().p, key, QCPDataKeyLess()));
+}
+
+/*!
+  Returns an iterator to the first data point with a key greater than \a key.
+*/
+QCPDataContainer::iterator QCPDataContainer::upperBound(double key)
+{
+  return iterator(std::upper_bound(begin().p, end().p, key, QCPDataKeyLess()));
+}
+
+/*! \overload
+*/
+QCPDataContainer::const_iterator QCPDataContainer::lowerBound(double key) const
+{
+  return const_iterator(std::lower_bound(begin().p, end().p, key, QCPDataKeyLess()));
+}
+
+/*! \overload
+*/
+QCPDataContainer::const_iterator QCPDataContainer::upperBound(double key) const
+{
+  return const_iterator(std::upper_bound(begin().p, end().p, key, QCPDataKeyLess()));
+}
+
+/*!
+  Replaces the contents with the points in \a keys and \a values. The number of points is the
+  size of the smaller vector. The points are copied in one pass; they are only sorted if
+  \a keys is not already in ascending order.
+*/
+void QCPDataContainer::assign(const QVector<double> &keys, const QVector<double> &values)
+{
+  int n = qMin(keys.size(), values.size());
+  mData.resize(n);
+  
+  QCPData *d = mData.data();
+  const double *k = keys.constData();
+  const double *v = values.constData();
+  bool sorted = true;
+  for (int i=0; i<n; ++i)
+  {
+    d[i] = QCPData(k[i], v[i]);
+    if (i > 0 && k[i] < k[i-1])
+      sorted = false;
+  }
+  
+  if (!sorted)
+    std::stable_sort(d, d+n, QCPDataKeyLess());
+}
+
+/*!
+  Removes the data point at \a it and returns an iterator to the following point.
+*/
+QCPDataContainer::iterator QCPDataContainer::erase(iterator it)
+{
+  return erase(it, it+1);
+}
+
+/*! \overload
+  Removes the data points in the range [\a first, \a last) and returns an iterator to the point
+  following the removed range.
+*/
+QCPDataContainer::iterator QCPDataContainer::erase(iterator first, iterator last)
+{
+  int i = first - begin();
+  mData.erase(mData.begin()+i, mData.begin()+(last - begin()));
+  return begin()+i;
+}
+
+/*!
+  Inserts \a value with the given \a key and returns an iterator to the new point. Appending
+  points in ascending key order is amortized constant time.
+*/
+QCPDataContainer::iterator QCPDataContainer::insertMulti(double key, const QCPData &value)
+{
+  QCPData d(value);
+  d.key = key;
+  
+  if (mData.isEmpty() || mData.last().key < key)
+  {
+    mData.append(d);
+    return end()-1;
+  }
+  
+  int i = lowerBound(key) - begin();
+  mData.insert(i, d);
+  return begin()+i;
+}
+
+/*!
+  Removes all data points with the given \a key and returns the number of points removed.
+*/
+int QCPDataContainer::remove(double key)
+{
+  iterator first = lowerBound(key);
+  iterator last = upperBound(key);
+  int n = last - first;
+  if (n > 0)
+    erase(first, last);
+  return n;
+}
+
+/*!
+  Merges the points of \a other into this container.
+*/
+void QCPDataContainer::unite(const QCPDataContainer &other)
+{
+  if (other.isEmpty())
+    return;
+  
+  int n = mData.size();
+  mData.resize(n + other.size());
+  std::copy(other.begin().p, other.end().p, mData.data()+n);
+  std::inplace_merge(mData.data(), mData.data()+n, mData.data()+mData.size(), QCPDataKeyLess());
+}
+
 // ================================================================================
 // =================== QCPCurveData
 // ================================================================================
@@ -372,6 +526,7 @@ QCPGraph::~QCPGraph()
 */
 void QCPGraph::setData(QCPDataMap *data, bool copy)
 {
+  if (mParentPlot) mParentPlot->invalidateCache();
   if (copy)
   {
     *mData = *data;
@@ -390,16 +545,8 @@ void QCPGraph::setData(QCPDataMap *data, bool copy)
 */
 void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value)
 {
-  mData->clear();
-  int n = key.size();
-  n = qMin(n, value.size());
-  QCPData newData;
-  for (int i=0; i<n; ++i)
-  {
-    newData.key = key[i];
-    newData.value = value[i];
-    mData->insertMulti(newData.key, newData);
-  }
+  if (mParentPlot) mParentPlot->invalidateCache();
+  mData->assign(key, value);
 }
 
 /*!
@@ -413,6 +560,7 @@ void QCPGraph::setData(const QVector<double> &key, const QVector<double> &value)
 */
 void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &valueError)
 {
+  if (mParentPlot) mParentPlot->invalidateCache();
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -439,6 +587,7 @@ void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<doubl
 */
 void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &valueErrorMinus, const QVector<double> &valueErrorPlus)
 {
+  if (mParentPlot) mParentPlot->invalidateCache();
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -466,6 +615,7 @@ void QCPGraph::setDataValueError(const QVector<double> &key, const QVector<doubl
 */
 void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyError)
 {
+  if (mParentPlot) mParentPlot->invalidateCache();
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -492,6 +642,7 @@ void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double>
 */
 void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus)
 {
+  if (mParentPlot) mParentPlot->invalidateCache();
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -519,6 +670,7 @@ void QCPGraph::setDataKeyError(const QVector<double> &key, const QVector<double>
 */
 void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyError, const QVector<double> &valueError)
 {
+  if (mParentPlot) mParentPlot->invalidateCache();
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -548,6 +700,7 @@ void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double
 */
 void QCPGraph::setDataBothError(const QVector<double> &key, const QVector<double> &value, const QVector<double> &keyErrorMinus, const QVector<double> &keyErrorPlus, const QVector<double> &valueErrorMinus, const QVector<double> &valueErrorPlus)
 {
+  if (mParentPlot) mParentPlot->invalidateCache();
   mData->clear();
   int n = key.size();
   n = qMin(n, value.size());
@@ -694,6 +847,7 @@ void QCPGraph::setChannelFillGraph(QCPGraph *targetGraph)
 */
 void QCPGraph::addData(const QCPDataMap &dataMap)
 {
+  if (mParentPlot) mParentPlot->invalidateCache();
   mData->unite(dataMap);
 }
 
@@ -703,6 +857,7 @@ void QCPGraph::addData(const QCPDataMap &dataMap)
 */
 void QCPGraph::addData(const QCPData &data)
 {
+  if (mParentPlot) mParentPlot->invalidateCache();
   mData->insertMulti(data.key, data);
 }
 
@@ -712,6 +867,7 @@ void QCPGraph::addData(const QCPData &data)
 */
 void QCPGraph::addData(double key, double value)
 {
+  if (mParentPlot) mParentPlot->invalidateCache();
   QCPData newData;
   newData.key = key;
   newData.value = value;
@@ -724,14 +880,10 @@ void QCPGraph::addData(double key, double value)
 */
 void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &values)
 {
-  int n = qMin(keys.size(), values.size());
-  QCPData newData;
-  for (int i=0; i<n; ++i)
-  {
-    newData.key = keys[i];
-    newData.value = values[i];
-    mData->insertMulti(newData.key, newData);
-  }
+  if (mParentPlot) mParentPlot->invalidateCache();
+  QCPDataMap newData;
+  newData.assign(keys, values);
+  mData->unite(newData);
 }
 
 /*!
@@ -740,9 +892,8 @@ void QCPGraph::addData(const QVector<double> &keys, const QVector<double> &value
 */
 void QCPGraph::removeDataBefore(double key)
 {
-  QCPDataMap::iterator it = mData->begin();
-  while (it != mData->end() && it.key() < key)
-    it = mData->erase(it);
+  if (mParentPlot) mParentPlot->invalidateCache();
+  mData->erase(mData->begin(), mData->lowerBound(key));
 }
 
 /*!
@@ -751,10 +902,9 @@ void QCPGraph::removeDataBefore(double key)
 */
 void QCPGraph::removeDataAfter(double key)
 {
+  if (mParentPlot) mParentPlot->invalidateCache();
   if (mData->isEmpty()) return;
-  QCPDataMap::iterator it = mData->upperBound(key);
-  while (it != mData->end())
-    it = mData->erase(it);
+  mData->erase(mData->upperBound(key), mData->end());
 }
 
 /*!
@@ -766,11 +916,11 @@ void QCPGraph::removeDataAfter(double key)
 */
 void QCPGraph::removeData(double fromKey, double toKey)
 {
+  if (mParentPlot) mParentPlot->invalidateCache();
   if (fromKey >= toKey || mData->isEmpty()) return;
   QCPDataMap::iterator it = mData->upperBound(fromKey);
   QCPDataMap::iterator itEnd = mData->upperBound(toKey);
-  while (it != itEnd)
-    it = mData->erase(it);
+  mData->erase(it, itEnd);
 }
 
 /*! \overload
@@ -783,6 +933,7 @@ void QCPGraph::removeData(double fromKey, double toKey)
 */
 void QCPGraph::removeData(double key)
 {
+  if (mParentPlot) mParentPlot->invalidateCache();
   mData->remove(key);
 }
 
@@ -792,6 +943,7 @@ void QCPGraph::removeData(double key)
 */
 void QCPGraph::clearData()
 {
+  if (mParentPlot) mParentPlot->invalidateCache();
   mData->clear();
 }
 
@@ -1661,7 +1813,7 @@ void QCPGraph::drawError(QCPPainter *painter, double x, double y, const QCPData
 */
 void QCPGraph::getVisibleDataBounds(QCPDataMap::const_iterator &lower, QCPDataMap::const_iterator &upper, int &count) const
 {
-  // get visible data range as QMap iterators
+  // get visible data range as container iterators (binary search)
   QCPDataMap::const_iterator lbound = mData->lowerBound(mKeyAxis->range().lower);
   QCPDataMap::const_iterator ubound = mData->upperBound(mKeyAxis->range().upper)-1;
   bool lowoutlier = lbound != mData->constBegin(); // indicates whether there exist points below axis range
@@ -1670,13 +1822,7 @@ void QCPGraph::getVisibleDataBounds(QCPDataMap::const_iterator &lower, QCPDataMa
   upper = (highoutlier ? ubound+1 : ubound); // data pointrange that will be actually drawn
   
   // count number of points in range lower to upper (including them), so we can allocate array for them in draw functions:
-  QCPDataMap::const_iterator it = lower;
-  count = 1;
-  while (it != upper)
-  {
-    ++it;
-    ++count;
-  }
+  count = upper - lower + 1;
 }
 
 /*! 
@@ -5759,7 +5905,10 @@ QCustomPlot::QCustomPlot(QWidget *parent) :
   QWidget(parent),
   mDragging(false),
   mReplotting(false),
-  mPlottingHints(QCP::phNone)
+  mPlottingHints(QCP::phNone),
+  mCachedLayer(0),
+  mCacheValid(false),
+  mReplotQueued(false)
 {
   setAttribute(Qt::WA_NoMousePropagation);
   setAttribute(Qt::WA_OpaquePaintEvent);
@@ -6110,6 +6259,7 @@ void QCustomPlot::setRangeZoomFactor(double factor)
 */
 void QCustomPlot::setAntialiasedElements(const QCP::AntialiasedElements &antialiasedElements)
 {
+  mCacheValid = false;
   mAntialiasedElements = antialiasedElements;
   
   // make sure elements aren't in mNotAntialiasedElements and mAntialiasedElements simultaneously:
@@ -6133,6 +6283,7 @@ void QCustomPlot::setAntialiasedElements(const QCP::AntialiasedElements &antiali
 */
 void QCustomPlot::setAntialiasedElement(QCP::AntialiasedElement antialiasedElement, bool enabled)
 {
+  mCacheValid = false;
   if (!enabled && mAntialiasedElements.testFlag(antialiasedElement))
     mAntialiasedElements &= ~antialiasedElement;
   else if (enabled && !mAntialiasedElements.testFlag(antialiasedElement))
@@ -6163,6 +6314,7 @@ void QCustomPlot::setAntialiasedElement(QCP::AntialiasedElement antialiasedEleme
 */
 void QCustomPlot::setNotAntialiasedElements(const QCP::AntialiasedElements &notAntialiasedElements)
 {
+  mCacheValid = false;
   mNotAntialiasedElements = notAntialiasedElements;
   
   // make sure elements aren't in mNotAntialiasedElements and mAntialiasedElements simultaneously:
@@ -6189,6 +6341,7 @@ void QCustomPlot::setNotAntialiasedElements(const QCP::AntialiasedElements &notA
 */
 void QCustomPlot::setNotAntialiasedElement(QCP::AntialiasedElement notAntialiasedElement, bool enabled)
 {
+  mCacheValid = false;
   if (!enabled && mNotAntialiasedElements.testFlag(notAntialiasedElement))
     mNotAntialiasedElements &= ~notAntialiasedElement;
   else if (enabled && !mNotAntialiasedElements.testFlag(notAntialiasedElement))
@@ -6485,6 +6638,7 @@ QCPAbstractPlottable *QCustomPlot::plottable()
 */
 bool QCustomPlot::addPlottable(QCPAbstractPlottable *plottable)
 {
+  mCacheValid = false;
   if (mPlottables.contains(plottable))
   {
     qDebug() << Q_FUNC_INFO << "plottable already added to this QCustomPlot:" << reinterpret_cast<quintptr>(plottable);
@@ -6517,6 +6671,7 @@ bool QCustomPlot::addPlottable(QCPAbstractPlottable *plottable)
 */
 bool QCustomPlot::removePlottable(QCPAbstractPlottable *plottable)
 {
+  mCacheValid = false;
   if (!mPlottables.contains(plottable))
   {
     qDebug() << Q_FUNC_INFO << "plottable not in list:" << reinterpret_cast<quintptr>(plottable);
@@ -6558,6 +6713,7 @@ bool QCustomPlot::removePlottable(int index)
 */
 int QCustomPlot::clearPlottables()
 {
+  mCacheValid = false;
   int c = mPlottables.size();
   for (int i=c-1; i >= 0; --i)
     removePlottable(mPlottables[i]);
@@ -6821,6 +6977,7 @@ QCPAbstractItem *QCustomPlot::item() const
 */
 bool QCustomPlot::addItem(QCPAbstractItem *item)
 {
+  mCacheValid = false;
   if (!mItems.contains(item) && item->parentPlot() == this)
   {
     mItems.append(item);
@@ -6841,6 +6998,7 @@ bool QCustomPlot::addItem(QCPAbstractItem *item)
 */
 bool QCustomPlot::removeItem(QCPAbstractItem *item)
 {
+  mCacheValid = false;
   if (mItems.contains(item))
   {
     delete item;
@@ -6877,6 +7035,7 @@ bool QCustomPlot::removeItem(int index)
 */
 int QCustomPlot::clearItems()
 {
+  mCacheValid = false;
   int c = mItems.size();
   for (int i=c-1; i >= 0; --i)
     removeItem(mItems[i]);
@@ -7113,6 +7272,10 @@ bool QCustomPlot::removeLayer(QCPLayer *layer)
   // if removed layer is current layer, change current layer to layer below/above:
   if (layer == mCurrentLayer)
     setCurrentLayer(targetLayer);
+  // if removed layer is the cached layer, cache up to the layer below/above instead:
+  if (layer == mCachedLayer)
+    mCachedLayer = targetLayer;
+  mCacheValid = false;
   // remove layer:
   delete layer;
   mLayers.removeOne(layer);
@@ -7187,6 +7350,7 @@ QList<QCPLegend*> QCustomPlot::selectedLegends() const
 */
 void QCustomPlot::deselectAll()
 {
+  mCacheValid = false;
   // deselect plottables:
   QList<QCPAbstractPlottable*> selPlottables = selectedPlottables();
   for (int i=0; i<selPlottables.size(); ++i)
@@ -7222,6 +7386,7 @@ void QCustomPlot::replot()
   if (mReplotting) // incase signals loop back to replot slot
     return;
   mReplotting = true;
+  mReplotQueued = false;
   emit beforeReplot();
   mPaintBuffer.fill(mColor);
   QCPPainter painter;
@@ -7241,6 +7406,69 @@ void QCustomPlot::replot()
   mReplotting = false;
 }
 
+/*!
+  Schedules a replot for the next time control returns to the event loop. Any number of calls to
+  queueReplot (and any direct call to \ref replot) before then result in a single replot. Use this
+  instead of \ref replot when several properties are changed in response to one event.
+  
+  \see replot
+*/
+void QCustomPlot::queueReplot()
+{
+  if (mReplotQueued)
+    return;
+  mReplotQueued = true;
+  QMetaObject::invokeMethod(this, "processQueuedReplot", Qt::QueuedConnection);
+}
+
+/*! \internal
+  
+  Performs the replot scheduled by \ref queueReplot, unless a direct replot has already happened
+  in the meantime.
+*/
+void QCustomPlot::processQueuedReplot()
+{
+  if (mReplotQueued)
+    replot();
+}
+
+/*!
+  Sets the topmost layer whose contents are cached. The axis background and all layers up to and
+  including \a layer are rendered into a separate pixmap, which is reused by subsequent replots
+  as long as the viewport, axis rect and axis ranges stay the same and nothing invalidates the
+  cache. Only the layers above \a layer are redrawn in that case, so put frequently changing
+  overlays (items, cursors) on a layer above the cached layer.
+  
+  The cache is invalidated automatically when plottables or items are added or removed, graph data
+  changes, the selection changes through user interaction or the antialiasing settings change. Call
+  \ref invalidateCache after changing other properties of objects on the cached layers (e.g. pens).
+  
+  Pass 0 to disable caching (the default). Note that the title is drawn with the cached layers.
+  
+  \see invalidateCache
+*/
+void QCustomPlot::setCachedLayer(QCPLayer *layer)
+{
+  if (layer && !mLayers.contains(layer))
+  {
+    qDebug() << Q_FUNC_INFO << "layer not a layer of this QCustomPlot:" << reinterpret_cast<quintptr>(layer);
+    return;
+  }
+  mCachedLayer = layer;
+  mCacheValid = false;
+  if (!layer)
+    mCacheBuffer = QPixmap();
+}
+
+/*!
+  Marks the cached layers (see \ref setCachedLayer) as out of date, so they are redrawn on the
+  next replot.
+*/
+void QCustomPlot::invalidateCache()
+{
+  mCacheValid = false;
+}
+
 /*!
   Convenience function to make the top and right axes visible and assign them the following
   properties from their corresponding bottom/left axes:
@@ -7726,7 +7954,10 @@ void QCustomPlot::mouseReleaseEvent(QMouseEvent *event)
         selectionFound |= handleTitleSelection((!selectionFound || additiveSelection) ? event : 0, additiveSelection, emitChangedSignal);
       
       if (emitChangedSignal)
+      {
+        mCacheValid = false;
         emit selectionChangedByUser();
+      }
       doReplot = true;
     }
     
@@ -8044,11 +8275,51 @@ void QCustomPlot::draw(QCPPainter *painter)
   // position legend:
   legend->reArrange();
   
-  // draw axis background:
-  drawAxisBackground(painter);
+  int cachedIndex = mCachedLayer ? mLayers.indexOf(mCachedLayer) : -1;
+  if (cachedIndex >= 0 && painter->device() == &mPaintBuffer)
+  {
+    // draw axis background, cached layers and title from the cache, updating it if necessary:
+    QVector<double> signature = cacheSignature();
+    if (!mCacheValid || mCacheSignature != signature || mCacheBuffer.size() != mPaintBuffer.size())
+    {
+      mCacheBuffer = QPixmap(mPaintBuffer.size());
+      mCacheBuffer.fill(mColor);
+      QCPPainter cachePainter;
+      cachePainter.begin(&mCacheBuffer);
+      if (cachePainter.isActive())
+      {
+        cachePainter.setRenderHints(painter->renderHints());
+        drawAxisBackground(&cachePainter);
+        drawLayers(&cachePainter, 0, cachedIndex);
+        drawTitle(&cachePainter);
+        cachePainter.end();
+      }
+      mCacheSignature = signature;
+      mCacheValid = true;
+    }
+    painter->drawPixmap(0, 0, mCacheBuffer);
+    drawLayers(painter, cachedIndex+1, mLayers.size()-1);
+  } else
+  {
+    // draw axis background:
+    drawAxisBackground(painter);
+    
+    // draw all layered objects (grid, axes, plottables, items, legend,...):
+    drawLayers(painter, 0, mLayers.size()-1);
+    
+    // draw title:
+    drawTitle(painter);
+  }
+}
+
+/*! \internal
   
-  // draw all layered objects (grid, axes, plottables, items, legend,...):
-  for (int layerIndex=0; layerIndex < mLayers.size(); ++layerIndex)
+  Draws the visible children of the layers with indices \a first to \a last (inclusive) with the
+  passed \a painter.
+*/
+void QCustomPlot::drawLayers(QCPPainter *painter, int first, int last)
+{
+  for (int layerIndex=first; layerIndex <= last && layerIndex < mLayers.size(); ++layerIndex)
   {
     QList<QCPLayerable*> layerChildren = mLayers.at(layerIndex)->children();
     for (int k=0; k < layerChildren.size(); ++k)
@@ -8064,8 +8335,14 @@ void QCustomPlot::draw(QCPPainter *painter)
       }
     }
   }
+}
+
+/*! \internal
   
-  // draw title:
+  Draws the title, if set, with the passed \a painter.
+*/
+void QCustomPlot::drawTitle(QCPPainter *painter)
+{
   if (!mTitle.isEmpty())
   {
     painter->setFont(titleSelected() ? mSelectedTitleFont : mTitleFont);
@@ -8074,6 +8351,24 @@ void QCustomPlot::draw(QCPPainter *painter)
   }
 }
 
+/*! \internal
+  
+  Returns the values which determine whether the cached layers are still valid: the viewport and
+  axis rect geometry and the ranges of all four axes.
+  
+  \see setCachedLayer
+*/
+QVector<double> QCustomPlot::cacheSignature() const
+{
+  QVector<double> result;
+  result.reserve(16);
+  result << mViewport.x() << mViewport.y() << mViewport.width() << mViewport.height();
+  result << mAxisRect.x() << mAxisRect.y() << mAxisRect.width() << mAxisRect.height();
+  result << xAxis->range().lower << xAxis->range().upper << yAxis->range().lower << yAxis->range().upper;
+  result << xAxis2->range().lower << xAxis2->range().upper << yAxis2->range().lower << yAxis2->range().upper;
+  return result;
+}
+
 /*! \internal
 
   If an axis background is provided via \ref setAxisBackground, this function first buffers the
@@ -12558,7 +12853,9 @@ QCPItemPixmap::~QCPItemPixmap()
 */
 void QCPItemPixmap::setPixmap(const QPixmap &pixmap)
 {
+  if (mParentPlot) mParentPlot->invalidateCache();
   mPixmap = pixmap;
+  mScaledPixmap = QPixmap();
 }
 
 /*!
@@ -14014,6 +14311,7 @@ QCPLayerable::~QCPLayerable()
 */
 void QCPLayerable::setVisible(bool on)
 {
+  if (mParentPlot) mParentPlot->invalidateCache();
   mVisible = on;
 }
 
@@ -148,16 +148,94 @@ public:
 };
 Q_DECLARE_TYPEINFO(QCPData, Q_MOVABLE_TYPE);
 
+class QCP_LIB_DECL QCPDataContainer
+{
+public:
+  class const_iterator;
+  
+  class iterator
+  {
+  public:
+    iterator() : p(0) {}
+    explicit iterator(QCPData *d) : p(d) {}
+    double key() const { return p->key; }
+    QCPData &value() const { return *p; }
+    QCPData &operator*() const { return *p; }
+    QCPData *operator->() const { return p; }
+    bool operator==(const iterator &o) const { return p == o.p; }
+    bool operator!=(const iterator &o) const { return p != o.p; }
+    iterator &operator++() { ++p; return *this; }
+    iterator operator++(int) { iterator r = *this; ++p; return r; }
+    iterator &operator--() { --p; return *this; }
+    iterator operator--(int) { iterator r = *this; --p; return r; }
+    iterator operator+(int j) const { return iterator(p+j); }
+    iterator operator-(int j) const { return iterator(p-j); }
+    int operator-(const iterator &o) const { return int(p-o.p); }
+    QCPData *p;
+  };
+  
+  class const_iterator
+  {
+  public:
+    const_iterator() : p(0) {}
+    explicit const_iterator(const QCPData *d) : p(d) {}
+    const_iterator(const iterator &o) : p(o.p) {}
+    double key() const { return p->key; }
+    const QCPData &value() const { return *p; }
+    const QCPData &operator*() const { return *p; }
+    const QCPData *operator->() const { return p; }
+    bool operator==(const const_iterator &o) const { return p == o.p; }
+    bool operator!=(const const_iterator &o) const { return p != o.p; }
+    const_iterator &operator++() { ++p; return *this; }
+    const_iterator operator++(int) { const_iterator r = *this; ++p; return r; }
+    const_iterator &operator--() { --p; return *this; }
+    const_iterator operator--(int) { const_iterator r = *this; --p; return r; }
+    const_iterator operator+(int j) const { return const_iterator(p+j); }
+    const_iterator operator-(int j) const { return const_iterator(p-j); }
+    int operator-(const const_iterator &o) const { return int(p-o.p); }
+    const QCPData *p;
+  };
+  
+  QCPDataContainer() {}
+  
+  // getters:
+  int size() const { return mData.size(); }
+  bool isEmpty() const { return mData.isEmpty(); }
+  iterator begin() { return iterator(mData.data()); }
+  iterator end() { return iterator(mData.data()+mData.size()); }
+  const_iterator begin() const { return const_iterator(mData.constData()); }
+  const_iterator end() const { return const_iterator(mData.constData()+mData.size()); }
+  const_iterator constBegin() const { return begin(); }
+  const_iterator constEnd() const { return end(); }
+  iterator lowerBound(double key);
+  iterator upperBound(double key);
+  const_iterator lowerBound(double key) const;
+  const_iterator upperBound(double key) const;
+  
+  // non-property methods:
+  void assign(const QVector<double> &keys, const QVector<double> &values);
+  void clear() { mData.clear(); }
+  iterator erase(iterator it);
+  iterator erase(iterator first, iterator last);
+  iterator insertMulti(double key, const QCPData &value);
+  int remove(double key);
+  void reserve(int size) { mData.reserve(size); }
+  void unite(const QCPDataContainer &other);
+  
+protected:
+  QVector<QCPData> mData;
+};
+
 /*! \typedef QCPDataMap
   Container for storing QCPData items in a sorted fashion. The key of the map
   is the key member of the QCPData instance.
   
-  This is the container in which QCPGraph holds its data.
-  \see QCPData, QCPGraph::setData
+  This is the container in which QCPGraph holds its data. It is a \ref QCPDataContainer,
+  which provides the subset of the QMap interface used by QCPGraph on top of a contiguous,
+  sorted array.
+  \see QCPData, QCPDataContainer, QCPGraph::setData
 */
-typedef QMap<double, QCPData> QCPDataMap;
-typedef QMapIterator<double, QCPData> QCPDataMapIterator;
-typedef QMutableMapIterator<double, QCPData> QCPDataMutableMapIterator;
+typedef QCPDataContainer QCPDataMap;
 
 class QCP_LIB_DECL QCPCurveData
 {
@@ -2063,6 +2141,9 @@ public:
   bool addLayer(const QString &name, QCPLayer *otherLayer=0, LayerInsertMode insertMode=limAbove);
   bool removeLayer(QCPLayer *layer);
   bool moveLayer(QCPLayer *layer, QCPLayer *otherLayer, LayerInsertMode insertMode=limAbove);
+  QCPLayer *cachedLayer() const { return mCachedLayer; }
+  void setCachedLayer(QCPLayer *layer);
+  void invalidateCache();
   
   QList<QCPAxis*> selectedAxes() const;
   QList<QCPLegend*> selectedLegends() const;
@@ -2079,6 +2160,7 @@ public:
 public slots:
   void deselectAll();
   void replot();
+  void queueReplot();
   void rescaleAxes();
   
 signals:
@@ -2103,6 +2185,9 @@ signals:
   void beforeReplot();
   void afterReplot();
   
+protected slots:
+  void processQueuedReplot();
+  
 protected:
   QString mTitle;
   QFont mTitleFont, mSelectedTitleFont;
@@ -2139,6 +2224,11 @@ protected:
   QCPLayer *mCurrentLayer;
   QCP::PlottingHints mPlottingHints;
   Qt::KeyboardModifier mMultiSelectModifier;
+  QCPLayer *mCachedLayer;
+  QPixmap mCacheBuffer;
+  QVector<double> mCacheSignature;
+  bool mCacheValid;
+  bool mReplotQueued;
   
   // reimplemented methods:
   virtual QSize minimumSizeHint() const;
@@ -2158,6 +2248,9 @@ protected:
   // introduced methods:
   virtual void draw(QCPPainter *painter);
   virtual void drawAxisBackground(QCPPainter *painter);
+  void drawLayers(QCPPainter *painter, int first, int last);
+  void drawTitle(QCPPainter *painter);
+  QVector<double> cacheSignature() const;
   
   // helpers:
   void updateAxisRect();
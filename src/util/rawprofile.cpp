@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <cstring>
+
+#include <QByteArray>
+
+#include "rawprofile.hpp"
+
+//! Packed Raw Profile Magic Number
+static const char raw_magic[4] = { 'B', 'R', 'Z', 2 };
+
+//! Packed Raw Profile Storage Methods
+#define RAW_METHOD_STORED		0
+#define RAW_METHOD_ZLIB			1
+
+//! Packed Raw Profile Header Size (magic, method, size, checksum)
+#define RAW_HEADER_SIZE			(sizeof(raw_magic) + 1 + 4 + 2)
+
+//! zlib Compression Level used for Raw Profiles
+#define RAW_COMPRESS_LEVEL		6
+
+/*
+ * Read the Header of a Packed Raw Profile Buffer.  Returns false if the buffer
+ * cannot be a packed buffer.  The checksum is not verified.
+ */
+static bool read_header(const std::vector<uint8_t> & data, int & method, size_t & size, quint16 & crc)
+{
+	if ((data.size() < RAW_HEADER_SIZE) || (memcmp(& data[0], raw_magic, sizeof(raw_magic)) != 0))
+		return false;
+
+	const uint8_t * h = & data[sizeof(raw_magic)];
+	method = h[0];
+	size = ((size_t)h[1] << 24) | ((size_t)h[2] << 16) | ((size_t)h[3] << 8) | h[4];
+	crc = (quint16)((h[5] << 8) | h[6]);
+
+	size_t len = data.size() - RAW_HEADER_SIZE;
+	if (method == RAW_METHOD_STORED)
+		return (len == size);
+	if (method == RAW_METHOD_ZLIB)
+		return (len > 0);
+
+	return false;
+}
+
+/*
+ * Unpack a Raw Profile Buffer.  Returns false if the buffer is not a valid
+ * packed buffer, in which case it holds uncompressed device data.
+ */
+static bool unpack(const std::vector<uint8_t> & data, std::vector<uint8_t> & raw, int & method)
+{
+	size_t size;
+	quint16 crc;
+	if (! read_header(data, method, size, crc))
+		return false;
+
+	const uint8_t * payload = & data[0] + RAW_HEADER_SIZE;
+	size_t len = data.size() - RAW_HEADER_SIZE;
+
+	if (method == RAW_METHOD_STORED)
+	{
+		raw.assign(payload, payload + len);
+	}
+	else
+	{
+		QByteArray z = qUncompress((const uchar *)payload, len);
+		if ((size_t)z.size() != size)
+			return false;
+
+		raw.assign(z.constData(), z.constData() + z.size());
+	}
+
+	return (raw.empty() ? 0 : qChecksum((const char *)& raw[0], raw.size())) == crc;
+}
+
+std::vector<uint8_t> compressRawProfile(const std::vector<uint8_t> & data)
+{
+	if (data.empty())
+		return data;
+
+	QByteArray z = qCompress((const uchar *)& data[0], data.size(), RAW_COMPRESS_LEVEL);
+	bool stored = ((size_t)z.size() >= data.size());
+
+	size_t size = data.size();
+	quint16 crc = qChecksum((const char *)& data[0], data.size());
+
+	std::vector<uint8_t> result;
+	result.reserve(RAW_HEADER_SIZE + (stored ? data.size() : z.size()));
+	result.insert(result.end(), raw_magic, raw_magic + sizeof(raw_magic));
+	result.push_back(stored ? RAW_METHOD_STORED : RAW_METHOD_ZLIB);
+	result.push_back((size >> 24) & 0xff);
+	result.push_back((size >> 16) & 0xff);
+	result.push_back((size >> 8) & 0xff);
+	result.push_back(size & 0xff);
+	result.push_back((crc >> 8) & 0xff);
+	result.push_back(crc & 0xff);
+
+	if (stored)
+		result.insert(result.end(), data.begin(), data.end());
+	else
+		result.insert(result.end(), z.constData(), z.constData() + z.size());
+
+	return result;
+}
+
+std::vector<uint8_t> decompressRawProfile(const std::vector<uint8_t> & data)
+{
+	std::vector<uint8_t> raw;
+	int method;
+	if (! unpack(data, raw, method))
+		return data;
+
+	return raw;
+}
+
+void rawProfileChecksum(const std::vector<uint8_t> & data, size_t & size, quint16 & crc)
+{
+	int method;
+	if (read_header(data, method, size, crc))
+		return;
+
+	size = data.size();
+	crc = data.empty() ? 0 : qChecksum((const char *)& data[0], data.size());
+}
+
+bool isCompressedRawProfile(const std::vector<uint8_t> & data)
+{
+	std::vector<uint8_t> raw;
+	int method;
+	return (unpack(data, raw, method) && (method == RAW_METHOD_ZLIB));
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef RAWPROFILE_HPP_
+#define RAWPROFILE_HPP_
+
+/**
+ * @file src/util/rawprofile.hpp
+ * @brief Raw Profile Compression Functions
+ * @author Jonathan Krauss <jkrauss@asymworks.com>
+ *
+ * The raw device buffer kept with each Profile is only needed to re-parse or
+ * export a dive, so it is stored compressed with qCompress().  Every buffer
+ * stored by this version starts with a header holding a magic number, the
+ * storage method (compressed or not), and the size and checksum of the
+ * device data.  A device buffer may itself start with the magic number, so a
+ * buffer is only taken as packed if the whole header matches the data that
+ * follows it; anything else is an uncompressed buffer stored by an earlier
+ * version.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <QtGlobal>
+
+/**
+ * @brief Compress a Raw Profile Buffer
+ * @param [in] Raw Device Buffer
+ * @return Packed Buffer, which is stored uncompressed after the header if
+ * compression does not save space
+ */
+std::vector<uint8_t> compressRawProfile(const std::vector<uint8_t> & data);
+
+/**
+ * @brief Decompress a Raw Profile Buffer
+ * @param [in] Stored Buffer (packed or from an earlier version)
+ * @return Raw Device Buffer
+ */
+std::vector<uint8_t> decompressRawProfile(const std::vector<uint8_t> & data);
+
+/**
+ * @brief Get the Size and Checksum of the Device Data in a Raw Profile Buffer
+ * @param [in] Stored Buffer (packed or from an earlier version)
+ * @param [out] Size of the Device Data in Bytes
+ * @param [out] CRC-16 of the Device Data (as computed by qChecksum())
+ *
+ * Packed buffers carry both values in their header, so they are not
+ * decompressed; the header checksum is trusted without being verified.
+ */
+void rawProfileChecksum(const std::vector<uint8_t> & data, size_t & size, quint16 & crc);
+
+/**
+ * @brief Check if a Raw Profile Buffer is Compressed
+ * @param [in] Stored Buffer
+ * @return If the Buffer is packed and its data is compressed
+ */
+bool isCompressedRawProfile(const std::vector<uint8_t> & data);
+
+#endif /* RAWPROFILE_HPP_ */
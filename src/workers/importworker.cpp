@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2011 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <QTimer>
+
+#include "importworker.hpp"
+
+//! Number of Profiles Committed per Transaction
+#define IMPORT_BATCH_SIZE		50
+
+ImportWorker::ImportWorker(Session::Ptr session, const profile_list_t & profiles, DiveComputer::Ptr dc, QObject * parent)
+	: QObject(parent), m_session(session), m_profiles(profiles), m_dc(dc), m_next(0)
+{
+}
+
+ImportWorker::~ImportWorker()
+{
+}
+
+void ImportWorker::commitBatch()
+{
+	try
+	{
+		size_t end = std::min<size_t>(m_next + IMPORT_BATCH_SIZE, m_profiles.size());
+		for ( ; m_next < end; ++m_next)
+			m_session->add(m_profiles[m_next]);
+
+		if (m_dc && (m_next == m_profiles.size()))
+			m_session->add(m_dc);
+
+		m_session->commit();
+	}
+	catch (std::exception & e)
+	{
+		emit importError(QString::fromStdString(e.what()));
+		emit finished();
+		return;
+	}
+
+	emit progress((int)m_next);
+
+	// Return to the Event Loop between Batches
+	if (m_next < m_profiles.size())
+		QTimer::singleShot(0, this, SLOT(commitBatch()));
+	else
+		emit finished();
+}
+
+void ImportWorker::start()
+{
+	if (! m_session)
+	{
+		emit finished();
+		return;
+	}
+
+	QTimer::singleShot(0, this, SLOT(commitBatch()));
+}
@@ -0,0 +1,129 @@
+/*
+ * Copyright (C) 2011 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef IMPORTWORKER_HPP_
+#define IMPORTWORKER_HPP_
+
+/**
+ * @file src/workers/importworker.hpp
+ * @brief Bulk Dive Import Worker Class
+ * @author Jonathan Krauss <jkrauss@asymworks.com>
+ */
+
+#include <QObject>
+#include <QString>
+
+/*
+ * FIX for broken Qt4 moc and BOOST_JOIN error
+ */
+#ifdef Q_MOC_RUN
+#define BOOST_NO_TEMPLATE_PARTIAL_SPECIALIZATION
+#endif
+
+#include <benthos/logbook/dive_computer.hpp>
+#include <benthos/logbook/profile.hpp>
+#include <benthos/logbook/session.hpp>
+
+#include "transferworker.hpp"
+
+using namespace benthos::logbook;
+
+/**
+ * @brief Bulk Dive Import Batch Committer
+ *
+ * Despite its name and location alongside the workers, this is not a
+ * QRunnable and never leaves the GUI thread.  It adds a list of parsed
+ * profiles (and their dives and mixes) to a logbook session.  The session is
+ * not thread-safe and its mapper events update the caches and models, so the
+ * profiles are committed in bounded batches, one batch per pass of the event
+ * loop, so the GUI stays responsive and no single transaction grows with the
+ * size of the transfer.  Progress is reported after each batch.  If a dive computer is
+ * given it is added with the final batch so that its transfer token and last
+ * transfer time are only saved along with the dives.
+ *
+ * Every insert fires the session mapper events, so the caller should suspend
+ * model notifications with CustomTableModel::beginBulkUpdate() while the
+ * import runs and refresh the models once with endBulkUpdate() afterwards.
+ * The worker is not deleted automatically; connect finished() to its
+ * deleteLater() slot.
+ */
+class ImportWorker: public QObject
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief Class Constructor
+	 * @param[in] Session instance where the dives will be persisted
+	 * @param[in] Profiles to Import
+	 * @param[in] Dive Computer to Update (may be empty)
+	 * @param[in] Parent object
+	 */
+	ImportWorker(Session::Ptr session, const profile_list_t & profiles, DiveComputer::Ptr dc = DiveComputer::Ptr(), QObject * parent = 0);
+
+	//! Class Destructor
+	virtual ~ImportWorker();
+
+public slots:
+
+	//! Start the Import from the Event Loop
+	void start();
+
+protected slots:
+
+	//! Commit the next Batch of Profiles
+	void commitBatch();
+
+signals:
+
+	/**
+	 * @brief Import Finished Signal
+	 *
+	 * Emitted when the import has completed, whether or not it succeeded.
+	 */
+	void finished();
+
+	/**
+	 * @brief Import Error Signal
+	 * @param[out] Error Message
+	 *
+	 * Emitted if a batch could not be committed.  Batches committed before
+	 * the error remain in the logbook.
+	 */
+	void importError(const QString &);
+
+	/**
+	 * @brief Import Progress Signal
+	 * @param[out] Number of Profiles Committed
+	 */
+	void progress(int);
+
+private:
+	Session::Ptr				m_session;
+	profile_list_t				m_profiles;
+	DiveComputer::Ptr			m_dc;
+	size_t						m_next;
+
+};
+
+#endif /* IMPORTWORKER_HPP_ */
@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <QPainter>
+#include <QPolygonF>
+#include <QVector>
+
+#include "plotrenderworker.hpp"
+
+PlotRenderWorker::PlotRenderWorker(const plot_render_t & snapshot, QAtomicInt * generation, int serial, QObject * parent)
+	: QObject(parent), m_snapshot(snapshot), m_generation(generation), m_serial(serial)
+{
+}
+
+PlotRenderWorker::~PlotRenderWorker()
+{
+}
+
+bool PlotRenderWorker::cancelled() const
+{
+	return ((int)(* m_generation) != m_serial);
+}
+
+void PlotRenderWorker::run()
+{
+	const plot_render_t & s = m_snapshot;
+	if (cancelled() || ! s.lod || ! s.lod->size() || s.axisRect.isEmpty())
+		return;
+
+	QVector<double> keys;
+	QVector<double> values;
+	s.lod->decimate(s.xLower, s.xUpper, s.axisRect.width(), keys, values);
+
+	if (cancelled())
+		return;
+
+	/*
+	 * Map the Data to Pixel Coordinates the same way QCPAxis::coordToPixel
+	 * does for linear axes
+	 */
+	const QRect & r = s.axisRect;
+	double xScale = r.width() / (s.xUpper - s.xLower);
+	double yScale = r.height() / (s.yUpper - s.yLower);
+
+	QPolygonF line(keys.size());
+	for (int i = 0; i < keys.size(); ++i)
+	{
+		double px = (keys[i] - s.xLower) * xScale + r.left();
+		double py = s.yReversed ? r.top() + (values[i] - s.yLower) * yScale : r.bottom() - (values[i] - s.yLower) * yScale;
+		line[i] = QPointF(px, py);
+	}
+
+	double py0 = s.yReversed ? r.top() - s.yLower * yScale : r.bottom() + s.yLower * yScale;
+
+	/*
+	 * Draw the Fill and Line in Widget Coordinates
+	 */
+	QImage img(r.size(), QImage::Format_ARGB32_Premultiplied);
+	img.fill(0);
+
+	QPainter p(& img);
+	p.setRenderHint(QPainter::Antialiasing);
+	p.translate(-r.topLeft());
+
+	if (! line.isEmpty() && (s.brush.style() != Qt::NoBrush))
+	{
+		QPolygonF fill(line);
+		fill << QPointF(line.last().x(), py0) << QPointF(line.first().x(), py0);
+
+		p.setPen(Qt::NoPen);
+		p.setBrush(s.brush);
+		p.drawPolygon(fill);
+	}
+
+	p.setPen(s.pen);
+	p.setBrush(Qt::NoBrush);
+	p.drawPolyline(line);
+	p.end();
+
+	if (cancelled())
+		return;
+
+	emit rendered(m_serial, img);
+}
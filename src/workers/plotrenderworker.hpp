@@ -0,0 +1,118 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef PLOTRENDERWORKER_HPP_
+#define PLOTRENDERWORKER_HPP_
+
+/**
+ * @file src/workers/plotrenderworker.hpp
+ * @brief Plot Render Worker Class
+ * @author Jonathan Krauss <jkrauss@asymworks.com>
+ */
+
+#include <QAtomicInt>
+#include <QBrush>
+#include <QImage>
+#include <QObject>
+#include <QPen>
+#include <QRect>
+#include <QRunnable>
+
+#include "util/profilelod.hpp"
+
+/**
+ * @brief Plot Render Snapshot
+ *
+ * Holds everything needed to draw a filled line graph without touching the
+ * plot widget: the series pyramid, the axis ranges, the axis rectangle in
+ * widget coordinates and the pen and brush.  The fill runs from the line to
+ * the zero value, and the brush is applied in widget coordinates so that
+ * gradients line up with the rest of the plot.
+ */
+typedef struct
+{
+	ProfileLOD::Ptr		lod;
+	QRect				axisRect;
+	double				xLower;
+	double				xUpper;
+	double				yLower;
+	double				yUpper;
+	bool				yReversed;
+	QPen				pen;
+	QBrush				brush;
+} plot_render_t;
+
+/**
+ * @brief Plot Render Worker
+ *
+ * Runnable which rasterizes a profile graph into a QImage the size of the
+ * plot's axis rectangle and passes it back to the caller through the
+ * rendered() signal, so that the GUI thread only has to blit the image.
+ *
+ * Requests are cancelled through a shared generation counter in the same
+ * way as the ProfileLoadWorker: the worker stops early if the counter
+ * changes, and the receiver should discard any image whose serial number is
+ * not the latest.
+ */
+class PlotRenderWorker: public QObject, public QRunnable
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief Class Constructor
+	 * @param[in] Render Snapshot
+	 * @param[in] Generation Counter
+	 * @param[in] Serial Number of this Request
+	 * @param[in] Parent object
+	 */
+	PlotRenderWorker(const plot_render_t & snapshot, QAtomicInt * generation, int serial, QObject * parent = 0);
+
+	//! Class Destructor
+	virtual ~PlotRenderWorker();
+
+	//! Run the Render
+	virtual void run();
+
+public:
+
+	//! @return If the Request has been Superseded
+	bool cancelled() const;
+
+signals:
+
+	/**
+	 * @brief Plot Rendered Signal
+	 * @param[out] Serial Number of the Request
+	 * @param[out] Rendered Image of the Axis Rectangle
+	 */
+	void rendered(int, const QImage &);
+
+private:
+	plot_render_t				m_snapshot;
+	QAtomicInt *				m_generation;
+	int							m_serial;
+
+};
+
+#endif /* PLOTRENDERWORKER_HPP_ */
@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <QThread>
+
+#include "mvf/views/profile_cache.hpp"
+
+#include "prefetchworker.hpp"
+
+PrefetchWorker::PrefetchWorker(const std::vector<Profile::Ptr> & profiles, QAtomicInt * generation, int serial)
+	: QRunnable(), m_profiles(profiles), m_generation(generation), m_serial(serial)
+{
+}
+
+PrefetchWorker::~PrefetchWorker()
+{
+}
+
+bool PrefetchWorker::cancelled() const
+{
+	return ((int)(* m_generation) != m_serial);
+}
+
+void PrefetchWorker::run()
+{
+	if (cancelled())
+		return;
+
+	QThread::currentThread()->setPriority(QThread::LowestPriority);
+
+	std::vector<Profile::Ptr>::const_iterator it;
+	for (it = m_profiles.begin(); it != m_profiles.end(); it++)
+	{
+		if (cancelled())
+			return;
+
+		ProfileCache::Instance()->prefetch(* it);
+	}
+}
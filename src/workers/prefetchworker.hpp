@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef PREFETCHWORKER_HPP_
+#define PREFETCHWORKER_HPP_
+
+/**
+ * @file src/workers/prefetchworker.hpp
+ * @brief Profile Prefetch Worker Class
+ * @author Jonathan Krauss <jkrauss@asymworks.com>
+ */
+
+#include <vector>
+
+#include <QAtomicInt>
+#include <QRunnable>
+
+/*
+ * FIX for broken Qt4 moc and BOOST_JOIN error
+ */
+#ifdef Q_MOC_RUN
+#define BOOST_NO_TEMPLATE_PARTIAL_SPECIALIZATION
+#endif
+
+#include <benthos/logbook/profile.hpp>
+
+using namespace benthos::logbook;
+
+/**
+ * @brief Profile Prefetch Worker
+ *
+ * Runnable which decodes a list of profiles into the ProfileCache so that
+ * they are ready when the user selects one of their dives.  The profiles are
+ * looked up by the caller on the GUI thread, since the logbook session is
+ * not thread-safe; the worker does not use the session.  The worker lowers
+ * the priority of its thread while it runs.
+ *
+ * The worker is cancelled through a shared generation counter: it is created
+ * with the value of the counter at the time of the request and stops as soon
+ * as the counter no longer matches.  The owner must increment the counter
+ * and wait for its thread pool to finish before destroying the counter.
+ */
+class PrefetchWorker: public QRunnable
+{
+public:
+
+	/**
+	 * @brief Class Constructor
+	 * @param[in] Profiles to Prefetch, in Priority Order
+	 * @param[in] Generation Counter
+	 * @param[in] Generation of this Request
+	 */
+	PrefetchWorker(const std::vector<Profile::Ptr> & profiles, QAtomicInt * generation, int serial);
+
+	//! Class Destructor
+	virtual ~PrefetchWorker();
+
+	//! Run the Prefetch
+	virtual void run();
+
+public:
+
+	//! @return If the Prefetch has been Superseded
+	bool cancelled() const;
+
+private:
+	std::vector<Profile::Ptr>	m_profiles;
+	QAtomicInt *				m_generation;
+	int							m_serial;
+
+};
+
+#endif /* PREFETCHWORKER_HPP_ */
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include "profileloadworker.hpp"
+
+ProfileLoadWorker::ProfileLoadWorker(const profile_load_t & request, QAtomicInt * generation, int serial, QObject * parent)
+	: QObject(parent), m_request(request), m_generation(generation), m_serial(serial)
+{
+}
+
+ProfileLoadWorker::~ProfileLoadWorker()
+{
+}
+
+bool ProfileLoadWorker::cancelled() const
+{
+	return ((int)(* m_generation) != m_serial);
+}
+
+void ProfileLoadWorker::run()
+{
+	if (cancelled())
+		return;
+
+	profile_load_t result(m_request);
+	if (result.profile)
+		result.data = ProfileCache::Instance()->data(result.profile);
+
+	emit loaded(m_serial, result);
+}
@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef PROFILELOADWORKER_HPP_
+#define PROFILELOADWORKER_HPP_
+
+/**
+ * @file src/workers/profileloadworker.hpp
+ * @brief Profile Load Worker Class
+ * @author Jonathan Krauss <jkrauss@asymworks.com>
+ */
+
+#include <vector>
+
+#include <QAtomicInt>
+#include <QObject>
+#include <QRunnable>
+
+/*
+ * FIX for broken Qt4 moc and BOOST_JOIN error
+ */
+#ifdef Q_MOC_RUN
+#define BOOST_NO_TEMPLATE_PARTIAL_SPECIALIZATION
+#endif
+
+#include <benthos/logbook/dive.hpp>
+#include <benthos/logbook/profile.hpp>
+
+#include "mvf/views/profile_cache.hpp"
+
+using namespace benthos::logbook;
+
+/**
+ * @brief Profile Load Result
+ *
+ * Holds the dive, its list of profiles, the profile selected for display
+ * and the decoded plot data for that profile.  The profile list is empty
+ * if the dive has no profiles.
+ */
+typedef struct
+{
+	Dive::Ptr					dive;
+	std::vector<Profile::Ptr>	profiles;
+	Profile::Ptr				profile;
+	ProfilePlotData::Ptr		data;
+} profile_load_t;
+
+/**
+ * @brief Profile Load Worker
+ *
+ * Runnable which decodes the selected profile of a dive through the
+ * ProfileCache, then passes the result back to the caller through the
+ * loaded() signal.  This keeps profile decoding off the GUI thread.  The
+ * caller looks up the profiles and selects the one to show on the GUI thread
+ * before queuing the load, since the logbook session is not thread-safe.
+ *
+ * Each request carries a serial number taken from a shared generation
+ * counter.  The worker stops early if the counter changes before it has
+ * finished, and the receiver should discard any result whose serial number
+ * is not the latest.  The owner must increment the counter and wait for its
+ * thread pool to finish before destroying the counter.
+ *
+ * @note profile_load_t must be registered with the Qt metadata system in
+ * order for the signal/slot to work across threads.  To register, add the
+ * following line to the application initialization:
+ * @code
+ * qRegisterMetaType<profile_load_t>("profile_load_t");
+ * @endcode
+ */
+class ProfileLoadWorker: public QObject, public QRunnable
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief Class Constructor
+	 * @param[in] Dive, Profiles and selected Profile to Load
+	 * @param[in] Generation Counter
+	 * @param[in] Serial Number of this Request
+	 * @param[in] Parent object
+	 */
+	ProfileLoadWorker(const profile_load_t & request, QAtomicInt * generation, int serial, QObject * parent = 0);
+
+	//! Class Destructor
+	virtual ~ProfileLoadWorker();
+
+	//! Run the Load
+	virtual void run();
+
+public:
+
+	//! @return If the Request has been Superseded
+	bool cancelled() const;
+
+signals:
+
+	/**
+	 * @brief Profile Loaded Signal
+	 * @param[out] Serial Number of the Request
+	 * @param[out] Load Result
+	 */
+	void loaded(int, const profile_load_t &);
+
+private:
+	profile_load_t				m_request;
+	QAtomicInt *				m_generation;
+	int							m_serial;
+
+};
+
+#endif /* PROFILELOADWORKER_HPP_ */
@@ -0,0 +1,142 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QLinearGradient>
+#include <QPainter>
+#include <QPolygonF>
+#include <QThread>
+#include <QVector>
+
+#include "mvf/views/profile_cache.hpp"
+
+#include "sparklineworker.hpp"
+
+SparklineWorker::SparklineWorker(qlonglong dive_id, Profile::Ptr profile, const QSize & size, const QString & diskFile, int serial, QObject * parent)
+	: QObject(parent), m_dive_id(dive_id), m_profile(profile), m_size(size), m_diskFile(diskFile), m_serial(serial)
+{
+}
+
+SparklineWorker::~SparklineWorker()
+{
+}
+
+QImage SparklineWorker::render() const
+{
+	ProfilePlotData::Ptr data = ProfileCache::Instance()->lookup(m_profile->id());
+	if (! data)
+		data = ProfilePlotData::Build(m_profile);
+
+	if (! data || ! data->hasChannel("depth"))
+		return QImage();
+
+	ProfileLOD::Ptr lod = data->channel("depth").lod;
+	if (! lod || (lod->size() < 2))
+		return QImage();
+
+	double xLower = lod->keys().first();
+	double xUpper = lod->keys().last();
+	if (xUpper <= xLower)
+		return QImage();
+
+	QVector<double> keys;
+	QVector<double> values;
+	lod->decimate(xLower, xUpper, m_size.width(), keys, values);
+
+	double yMax = 0;
+	for (int i = 0; i < values.size(); ++i)
+		if (values[i] > yMax)
+			yMax = values[i];
+
+	if (yMax <= 0)
+		return QImage();
+
+	/*
+	 * Depth increases downwards with the surface at the top of the image
+	 */
+	double w = m_size.width() - 1;
+	double h = m_size.height() - 1;
+	QPolygonF line;
+	for (int i = 0; i < keys.size(); ++i)
+	{
+		if ((keys[i] < xLower) || (keys[i] > xUpper))
+			continue;
+
+		line << QPointF((keys[i] - xLower) * w / (xUpper - xLower), values[i] * h / yMax);
+	}
+
+	QImage img(m_size, QImage::Format_ARGB32_Premultiplied);
+	img.fill(0);
+
+	QPainter p(& img);
+	p.setRenderHint(QPainter::Antialiasing);
+
+	QPolygonF fill(line);
+	fill << QPointF(line.last().x(), 0) << QPointF(line.first().x(), 0);
+
+	QLinearGradient lg(0, 0, 0, h);
+	lg.setColorAt(0, QColor(255, 255, 255, 255));
+	lg.setColorAt(0.6, QColor(0, 64, 112, 255));
+
+	p.setPen(Qt::NoPen);
+	p.setBrush(lg);
+	p.drawPolygon(fill);
+
+	p.setPen(QColor(128, 128, 128, 255));
+	p.setBrush(Qt::NoBrush);
+	p.drawPolyline(line);
+	p.end();
+
+	return img;
+}
+
+void SparklineWorker::run()
+{
+	QThread::currentThread()->setPriority(QThread::LowestPriority);
+
+	if (! m_profile)
+	{
+		emit rendered(m_dive_id, m_serial, QImage());
+		return;
+	}
+
+	QImage img;
+
+	if (! m_diskFile.isEmpty() && QFile::exists(m_diskFile))
+	{
+		img.load(m_diskFile, "PNG");
+		if (img.size() != m_size)
+			img = QImage();
+	}
+
+	if (img.isNull())
+	{
+		img = render();
+
+		if (! img.isNull() && ! m_diskFile.isEmpty() && QDir().mkpath(QFileInfo(m_diskFile).absolutePath()))
+			img.save(m_diskFile, "PNG");
+	}
+
+	emit rendered(m_dive_id, m_serial, img);
+}
@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2013 Asymworks, LLC.  All Rights Reserved.
+ * www.asymworks.com / info@asymworks.com
+ *
+ * This file is part of the Benthos Dive Log Package (benthos-log.com)
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+
+#ifndef SPARKLINEWORKER_HPP_
+#define SPARKLINEWORKER_HPP_
+
+/**
+ * @file src/workers/sparklineworker.hpp
+ * @brief Profile Sparkline Worker Class
+ * @author Jonathan Krauss <jkrauss@asymworks.com>
+ */
+
+#include <QImage>
+#include <QObject>
+#include <QRunnable>
+#include <QSize>
+#include <QString>
+
+/*
+ * FIX for broken Qt4 moc and BOOST_JOIN error
+ */
+#ifdef Q_MOC_RUN
+#define BOOST_NO_TEMPLATE_PARTIAL_SPECIALIZATION
+#endif
+
+#include <benthos/logbook/profile.hpp>
+using namespace benthos::logbook;
+
+/**
+ * @brief Profile Sparkline Worker
+ *
+ * Runnable which draws a small depth thumbnail of a dive's default profile
+ * and passes it back through the rendered() signal.  The profile is resolved
+ * by the caller on the GUI thread, so the worker never touches the logbook
+ * session.  If a disk cache file is given, it is loaded first and the profile
+ * is only decoded if the file is missing; newly rendered thumbnails are then
+ * saved to it so that they survive between sessions.
+ *
+ * Plot data already in the ProfileCache is reused; otherwise the profile is
+ * decoded without adding it to the cache, so that scrolling through the dive
+ * list does not evict the profiles the user has been viewing.
+ */
+class SparklineWorker: public QObject, public QRunnable
+{
+	Q_OBJECT
+
+public:
+
+	/**
+	 * @brief Class Constructor
+	 * @param[in] Dive Identifier
+	 * @param[in] Default Profile of the Dive
+	 * @param[in] Thumbnail Size
+	 * @param[in] Disk Cache File (empty to disable)
+	 * @param[in] Serial Number of this Request
+	 * @param[in] Parent object
+	 */
+	SparklineWorker(qlonglong dive_id, Profile::Ptr profile, const QSize & size, const QString & diskFile, int serial, QObject * parent = 0);
+
+	//! Class Destructor
+	virtual ~SparklineWorker();
+
+	//! Run the Render
+	virtual void run();
+
+protected:
+
+	//! @return Rendered Thumbnail for the Profile
+	QImage render() const;
+
+signals:
+
+	/**
+	 * @brief Thumbnail Rendered Signal
+	 * @param[out] Dive Identifier
+	 * @param[out] Serial Number of the Request
+	 * @param[out] Thumbnail Image (null if the dive has no profile)
+	 */
+	void rendered(qlonglong, int, const QImage &);
+
+private:
+	qlonglong					m_dive_id;
+	Profile::Ptr				m_profile;
+	QSize						m_size;
+	QString						m_diskFile;
+	int							m_serial;
+
+};
+
+#endif /* SPARKLINEWORKER_HPP_ */
@@ -20,14 +20,21 @@
  * 02110-1301, USA.
  */
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
 #include <ctime>
 #include <map>
 #include <stdexcept>
 #include <string>
 
 #include <QMetaType>
+#include <QMutexLocker>
+#include <QStringList>
+#include <QThread>
 
 #include <benthos/logbook/dive.hpp>
+#include <benthos/logbook/logging.hpp>
 #include <benthos/logbook/mix.hpp>
 
 #include <benthos/divecomputer/config.hpp>
@@ -37,27 +44,81 @@
 
 #include <yajl/yajl_gen.h>
 
+#include "util/rawprofile.hpp"
+
 #include "transferworker.hpp"
 
 using namespace benthos::dc;
 using namespace benthos::logbook;
 
+//! Maximum Number of Dives per parsedDives() Batch
+#define TRANSFER_BATCH_SIZE		32
+
+//! Maximum Time between parsedDives() Batches (ms)
+#define TRANSFER_BATCH_MS		200
+
+//! Minimum Interval between progress() Signals (ms)
+#define TRANSFER_PROGRESS_MS	100
+
+//! Progress Interval of the Emulated Device (ms)
+#define EMULATOR_STEP_MS		20
+
 typedef std::map<uint8_t, int32_t>						vendor_entry_t;
 typedef std::map<std::string, vendor_entry_t, cicmp>	vendor_data_t;
 
+/*
+ * Waypoint Channel Slots.  The slot order matches the sort order of the key
+ * names so that the waypoint data map can be filled with hinted inserts.
+ */
+enum
+{
+	wpDepth = 0,
+	wpPressure,
+	wpTemp,
+	wpNumChannels
+};
+
+//! Interned Waypoint Channel Keys, indexed by Slot
+static const std::string wp_keys[wpNumChannels] = { "depth", "pressure", "temp" };
+
+/**
+ * @brief Waypoint Builder
+ *
+ * Collects the channel values of the waypoint being parsed in fixed slots.
+ * The waypoint itself is constructed in place at the end of the profile list
+ * and the slots are written into its data map when the next waypoint starts,
+ * so no waypoint is copied and no key strings are built per sample.
+ */
+typedef struct
+{
+	double							values[wpNumChannels];
+	bool							present[wpNumChannels];
+} waypoint_slots;
+
 typedef struct
 {
 	Dive::Ptr						dive;
-	waypoint						curwp;
+	waypoint_slots					slots;
 	Mix::Ptr						curmix;
 	bool							haswp;
 	std::list<waypoint>				profile;
 	std::map<uint8_t, Mix::Ptr>		mixes;
 	vendor_data_t					vendor;
-	IMixFinder::Ptr					mixfinder;
+	MixTable *						mixtable;
+	std::vector<capture_token_t> *	record;
 
 } parser_data;
 
+//! Exposes QThread::msleep() to the Emulated Device
+class EmulatorThread: public QThread
+{
+public:
+	static void msleep(unsigned long ms)
+	{
+		QThread::msleep(ms);
+	}
+};
+
 std::string json_encode(const vendor_data_t & data)
 {
 	yajl_gen g = yajl_gen_alloc(NULL);
@@ -147,10 +208,11 @@ void parse_header(void * userdata, uint8_t token, int32_t value, uint8_t index,
 	{
 	case DIVE_HEADER_START_TIME:
 	{
+		// gmtime() uses a shared buffer and headers are parsed in parallel
 		st = (time_t)value;
-		struct tm * tmp;
-		tmp = gmtime(& st);
-		_data->dive->setDateTime(mktime(tmp));
+		struct tm tm;
+		gmtime_r(& st, & tm);
+		_data->dive->setDateTime(mktime(& tm));
 		break;
 	}
 
@@ -310,16 +372,37 @@ void parse_header(void * userdata, uint8_t token, int32_t value, uint8_t index,
 
 void process_header(parser_data * _data)
 {
-	// Check for mixes that are already in the database
+	// Check for mixes that are already in the logbook or seen in a transfer
 	std::map<uint8_t, Mix::Ptr>::iterator it;
 	for (it = _data->mixes.begin(); it != _data->mixes.end(); it++)
+		it->second = _data->mixtable->resolve(it->second);
+}
+
+void flush_waypoint(parser_data * _data)
+{
+	std::map<std::string, double> & data = _data->profile.back().data;
+	for (int i = 0; i < wpNumChannels; ++i)
 	{
-		Mix::Ptr mix = _data->mixfinder->findByMix(it->second->o2_permil(), it->second->he_permil());
-		if (mix)
-			it->second = mix;
+		if (_data->slots.present[i])
+			data.insert(data.end(), std::pair<const std::string, double>(wp_keys[i], _data->slots.values[i]));
+		_data->slots.present[i] = false;
 	}
 }
 
+void set_slot(parser_data * _data, int slot, double value)
+{
+	// Drop values reported before the first Waypoint, as the other tokens do
+	if (! _data->haswp)
+		return;
+
+	// Keep the first value if a channel is reported twice, as map::insert did
+	if (_data->slots.present[slot])
+		return;
+
+	_data->slots.values[slot] = value;
+	_data->slots.present[slot] = true;
+}
+
 void parse_profile(void * userdata, uint8_t token, int32_t value, uint8_t index, const char * name)
 {
 	parser_data * _data = (parser_data *)userdata;
@@ -340,12 +423,12 @@ void parse_profile(void * userdata, uint8_t token, int32_t value, uint8_t index,
 		}
 
 		if (_data->haswp)
-			_data->profile.push_back(_data->curwp);
+			flush_waypoint(_data);
 
-		_data->curwp.alarms.clear();
-		_data->curwp.data.clear();
-		_data->curwp.mix = _data->curmix;
-		_data->curwp.time = value;
+		// Construct the new Waypoint in place
+		_data->profile.push_back(waypoint());
+		_data->profile.back().mix = _data->curmix;
+		_data->profile.back().time = value;
 		_data->haswp = true;
 
 		break;
@@ -353,43 +436,155 @@ void parse_profile(void * userdata, uint8_t token, int32_t value, uint8_t index,
 
 	case DIVE_WAYPOINT_DEPTH:
 	{
-		_data->curwp.data.insert(std::pair<std::string, double>("depth", value / 100.0f));
+		set_slot(_data, wpDepth, value / 100.0f);
 		break;
 	}
 
 	case DIVE_WAYPOINT_TEMP:
 	{
-		_data->curwp.data.insert(std::pair<std::string, double>("temp", value / 100.0f));
+		set_slot(_data, wpTemp, value / 100.0f);
 		break;
 	}
 
 	case DIVE_WAYPOINT_PX:
 	{
-		_data->curwp.data.insert(std::pair<std::string, double>("pressure", value / 1000.0f));
+		set_slot(_data, wpPressure, value / 1000.0f);
 		break;
 	}
 
 	case DIVE_WAYPOINT_MIX:
 	{
 		std::map<uint8_t, Mix::Ptr>::iterator it = _data->mixes.find(index);
-		if (it != _data->mixes.end())
-			_data->curwp.mix = it->second;
+		if ((it != _data->mixes.end()) && _data->haswp)
+			_data->profile.back().mix = it->second;
 
 		break;
 	}
 
 	case DIVE_WAYPOINT_ALARM:
 	{
-		if (name)
-			_data->curwp.alarms.insert(name);
+		if (name && _data->haswp)
+			_data->profile.back().alarms.insert(name);
 		break;
 	}
 	}
 }
 
+void record_token(parser_data * _data, bool header, uint8_t token, int32_t value, uint8_t index, const char * name)
+{
+	capture_token_t t;
+	t.header = header;
+	t.token = token;
+	t.index = index;
+	t.value = value;
+	if (name)
+		t.name = QByteArray(name);
+
+	_data->record->push_back(t);
+}
+
+void record_header(void * userdata, uint8_t token, int32_t value, uint8_t index, const char * name)
+{
+	record_token((parser_data *)userdata, true, token, value, index, name);
+	parse_header(userdata, token, value, index, name);
+}
+
+void record_profile(void * userdata, uint8_t token, int32_t value, uint8_t index, const char * name)
+{
+	record_token((parser_data *)userdata, false, token, value, index, name);
+	parse_profile(userdata, token, value, index, name);
+}
+
+void reset_parser(parser_data & data, Mix::Ptr air)
+{
+	// Setup Parser Data
+	data.dive.reset(new Dive);
+	data.mixes.clear();
+	data.profile.clear();
+	data.vendor.clear();
+
+	data.haswp = false;
+	data.curmix = air;
+
+	for (int i = 0; i < wpNumChannels; ++i)
+		data.slots.present[i] = false;
+}
+
+Profile::Ptr build_profile(DiveComputer::Ptr dc, const dive_buffer_t & buffer, parser_data & data)
+{
+	// Finish the final Waypoint
+	if (data.haswp)
+		flush_waypoint(& data);
+
+	// Update Dive Data
+	data.dive->setComputer(dc);
+
+	// Set the Dive Mix as the first Mix in the profile
+	if (data.haswp)
+		data.dive->setMix(data.profile.begin()->mix);
+
+	// Create Profile
+	Profile::Ptr profile = Profile::Ptr(new Profile);
+	profile->setComputer(dc);
+	profile->setDive(data.dive);
+	profile->setImported(time(NULL));
+	profile->setProfile(data.profile);
+	profile->setRawProfile(compressRawProfile(buffer));
+	profile->setVendor(json_encode(data.vendor));
+
+	return profile;
+}
+
+/**
+ * @brief Transfer Parse Task
+ *
+ * Runnable which parses a single dive buffer for the TransferWorker.
+ */
+class TransferParseTask: public QRunnable
+{
+public:
+	TransferParseTask(TransferWorker * worker, unsigned long seq, dive_buffer_t & buffer)
+		: m_worker(worker), m_seq(seq), m_buffer()
+	{
+		m_buffer.swap(buffer);
+	}
+
+	virtual void run()
+	{
+		m_worker->parse_task(m_seq, m_buffer);
+	}
+
+private:
+	TransferWorker *	m_worker;
+	unsigned long		m_seq;
+	dive_buffer_t		m_buffer;
+
+};
+
+void logTransferStats(DiveComputer::Ptr dc, const transfer_stats_t & stats)
+{
+	std::string name = dc->name() ? dc->name().get() : dc->driver();
+	double xfrSecs = stats.transferMs / 1000.0;
+	double parseSecs = stats.parseMs / 1000.0;
+
+	logging::getLogger("gui.transfer")->info(
+		"transfer summary: device '%s' driver '%s': %lu bytes, %lu dives (%lu duplicates); "
+		"load %ld ms, connect %ld ms, transfer %ld ms (%.1f KB/s), "
+		"parse %ld ms (%.1f dives/s), persist %ld ms",
+		name.c_str(), dc->driver().c_str(), stats.bytes, stats.dives, stats.duplicates,
+		(long)stats.loadMs, (long)stats.connectMs,
+		(long)stats.transferMs, (xfrSecs > 0) ? stats.bytes / 1024.0 / xfrSecs : 0.0,
+		(long)stats.parseMs, (parseSecs > 0) ? stats.dives / parseSecs : 0.0,
+		(long)stats.persistMs);
+}
+
 TransferWorker::TransferWorker(DiveComputer::Ptr dc, Session::Ptr session, bool checkSerNo, bool updateToken, QObject * parent)
 	: QObject(parent), m_dc(dc), m_session(session), m_checkSN(checkSerNo), m_updateToken(updateToken),
-	  m_cancel(false), m_started(false)
+	  m_cancel(false), m_started(false), m_parsePool(0), m_parseThreads(QThread::idealThreadCount()),
+	  m_driver(), m_air(), m_mixes(),
+	  m_orderLock(), m_reorder(), m_batch(), m_batchTimer(), m_index(), m_queued(0), m_parsed(0), m_duplicates(0),
+	  m_progressTimer(), m_stats(), m_capturePath(), m_capture(), m_emulated(dc->driver() == EMULATOR_DRIVER),
+	  m_speed(1.0), m_replay(), m_replayBase(0)
 {
 }
 
@@ -407,6 +602,30 @@ bool TransferWorker::cancelled() const
 	return m_cancel;
 }
 
+void TransferWorker::prepare(MixTable::Ptr mixes)
+{
+	m_index.build(m_session, m_dc);
+
+	if (! mixes)
+	{
+		mixes.reset(new MixTable);
+		mixes->load(m_session);
+	}
+
+	m_mixes = mixes;
+	m_air = mixes->air();
+}
+
+void TransferWorker::setCaptureFile(const QString & path)
+{
+	m_capturePath = path;
+}
+
+void TransferWorker::setParseThreads(int count)
+{
+	m_parseThreads = std::max(count, 1);
+}
+
 int TransferWorker::driver_devinfo(uint8_t model, uint32_t serial, uint32_t ticks, std::string & token)
 {
 	QString dcname;
@@ -430,6 +649,10 @@ int TransferWorker::driver_devinfo(uint8_t model, uint32_t serial, uint32_t tick
 		return -1;
 	}
 
+	// Record the Device Information
+	if (! m_capturePath.isEmpty())
+		m_capture.setDevice(m_emulated ? m_replay.driver() : m_dc->driver(), model, serial, ticks);
+
 	// Set the Transfer Token
 	if (m_dc->token().is_initialized() && ! m_dc->token().get().empty())
 		token = m_dc->token().get();
@@ -455,8 +678,19 @@ void TransferWorker::driver_progress(uint32_t transferred, uint32_t total)
 		}
 
 		m_started = true;
+		m_progressTimer.start();
+		m_stats.bytes = transferred;
+		emit progress(transferred);
+		return;
 	}
 
+	m_stats.bytes = transferred;
+
+	// Rate-limit Progress Updates, but always report the final Update
+	if ((transferred < total) && (m_progressTimer.elapsed() < TRANSFER_PROGRESS_MS))
+		return;
+
+	m_progressTimer.restart();
 	emit progress(transferred);
 }
 
@@ -473,70 +707,117 @@ void transfer_callback_fn(void * data, uint32_t transferred, uint32_t total, int
 		obj->driver_progress(transferred, total);
 }
 
-void TransferWorker::parse_dives(Driver::Ptr driver, const dive_data_t & dives)
+void TransferWorker::emit_ordered(unsigned long seq, Profile::Ptr profile, const QByteArray & key)
 {
-	IMixFinder::Ptr mf = boost::dynamic_pointer_cast<IMixFinder>(m_session->finder<Mix>());
-	Mix::Ptr air = mf->findByName("Air");
+	QMutexLocker lock(& m_orderLock);
+	m_reorder.insert(std::pair<unsigned long, reorder_entry_t>(seq, reorder_entry_t(profile, key)));
+
+	/*
+	 * Move in-order Dives to the Batch, dropping Dives which are already in
+	 * the logbook.  Batches are emitted under the lock so that the queued
+	 * signals are posted in order.
+	 */
+	std::map<unsigned long, reorder_entry_t>::iterator it;
+	while (((it = m_reorder.begin()) != m_reorder.end()) && (it->first == m_parsed))
+	{
+		if (it->second.first && m_index.insert(it->second.second))
+			m_batch.push_back(it->second.first);
+		else
+			++m_duplicates;
 
-	parser_data data;
-	data.mixfinder = mf;
+		m_reorder.erase(it);
+		++m_parsed;
+	}
 
-	// Parse the Dives
-	dive_data_t::const_iterator it;
-	for (it = dives.begin(); it != dives.end(); it++)
+	if ((m_batch.size() >= TRANSFER_BATCH_SIZE) || (m_batchTimer.elapsed() >= TRANSFER_BATCH_MS))
+		flush_batch();
+}
+
+dive_data_t TransferWorker::emulate_transfer()
+{
+	char * token = NULL;
+	int free_token = 0;
+	if (device_info(this, m_replay.model(), m_replay.serial(), m_replay.ticks(), & token, & free_token))
+		throw std::runtime_error("Device information was rejected");
+
+	std::string start(token ? token : "");
+	if (token && free_token)
+		free(token);
+
+	// Skip the Dives up to and including the Transfer Token
+	const std::vector<capture_dive_t> & dives = m_replay.dives();
+	m_replayBase = 0;
+	if (! start.empty())
 	{
-		// Setup Parser Data
-		data.dive.reset(new Dive);
-		data.mixes.clear();
-		data.profile.clear();
-		data.vendor.clear();
+		for (size_t i = 0; i < dives.size(); ++i)
+			if (dives[i].token == start)
+				m_replayBase = i + 1;
+	}
 
-		data.haswp = false;
-		data.curmix = air;
+	uint32_t total = 0;
+	for (size_t i = m_replayBase; i < dives.size(); ++i)
+		total += dives[i].data.size();
 
-		// Parse the Header and Profile
-		driver->parse(it->first, & parse_header, & parse_profile, & data);
+	// Pace the Transfer by the captured Transfer Time
+	qint64 duration = 0;
+	if ((m_speed > 0) && m_replay.bytes())
+		duration = (qint64)(m_replay.transferMs() * ((double)total / m_replay.bytes()) / m_speed);
 
-		// Append the final Waypoint
-		if (data.haswp)
-			data.profile.push_back(data.curwp);
+	QElapsedTimer timer;
+	timer.start();
 
-		// Update Dive Data
-		data.dive->setComputer(m_dc);
+	int cancel = 0;
+	uint32_t transferred = 0;
+	transfer_callback_fn(this, transferred, total, & cancel);
+	while (! cancel && (transferred < total))
+	{
+		if (duration > 0)
+		{
+			EmulatorThread::msleep(EMULATOR_STEP_MS);
+			transferred = (uint32_t)std::min<qint64>(total, total * timer.elapsed() / duration);
+		}
+		else
+		{
+			transferred = total;
+		}
 
-		// Set the Dive Mix as the first Mix in the profile
-		if (data.haswp)
-			data.dive->setMix(data.profile.begin()->mix);
+		transfer_callback_fn(this, transferred, total, & cancel);
+	}
 
-		// Create Profile
-		Profile::Ptr profile = Profile::Ptr(new Profile);
-		profile->setComputer(m_dc);
-		profile->setDive(data.dive);
-		profile->setImported(time(NULL));
-		profile->setProfile(data.profile);
-		profile->setRawProfile(it->first);
-		profile->setVendor(json_encode(data.vendor));
+	if (cancel)
+		throw std::runtime_error("Transfer cancelled");
 
-		// Emit Parsed Dive
-		emit parsedDive(profile);
-	}
+	dive_data_t result;
+	for (size_t i = m_replayBase; i < dives.size(); ++i)
+		result.push_back(dive_entry_t(dives[i].data, dives[i].token));
+
+	return result;
 }
 
-void TransferWorker::run()
+void TransferWorker::flush_batch()
 {
-	dive_data_t dive_data;
-	QString dcname;
-	if (m_dc->name().is_initialized())
-		dcname = QString::fromStdString(m_dc->name().get());
-	else
-		dcname = QString("'%1' Device").arg(QString::fromStdString(m_dc->driver()));
+	m_batchTimer.restart();
 
-	emit status(QString("Starting Transfer from %1").arg(dcname));
+	if (! m_batch.empty())
+	{
+		profile_list_t batch;
+		batch.swap(m_batch);
+		emit parsedDives(batch);
+	}
 
+	emit parsed(m_parsed);
+}
+
+void TransferWorker::enqueue(dive_entry_t & dive)
+{
+	m_parsePool->start(new TransferParseTask(this, m_queued++, dive.first));
+}
+
+bool TransferWorker::open_device(const QString & dcname, QElapsedTimer & phase)
+{
 	// Load the Driver
 	PluginRegistry::Ptr reg = PluginRegistry::Instance();
 	DriverClass::Ptr dclass;
-	Driver::Ptr dev;
 	try
 	{
 		dclass = reg->loadDriver(m_dc->driver());
@@ -546,9 +827,11 @@ void TransferWorker::run()
 		emit transferError(QString("Failed to load driver '%1': %2")
 			.arg(QString::fromStdString(m_dc->driver()))
 			.arg(QString::fromStdString(e.what())));
-		return;
+		return false;
 	}
 
+	m_stats.loadMs = phase.restart();
+
 	emit status(QString("Loaded driver '%1'").arg(QString::fromStdString(m_dc->driver())));
 	emit status(QString("Connecting to '%1'").arg(dcname));
 
@@ -563,29 +846,152 @@ void TransferWorker::run()
 		if (m_dc->driver_args().is_initialized())
 			devargs = m_dc->driver_args().get();
 
-		dev = dclass->open(devpath, devargs);
+		m_driver = dclass->open(devpath, devargs);
 	}
 	catch (std::exception & e)
 	{
 		emit transferError(QString("Failed to connect to '%1': %2")
 			.arg(dcname)
 			.arg(QString::fromStdString(e.what())));
-		return;
+		return false;
+	}
+
+	m_stats.connectMs = phase.elapsed();
+
+	emit status(QString("Connected to '%1'").arg(dcname));
+	return true;
+}
+
+bool TransferWorker::open_emulator(const QString & dcname, QElapsedTimer & phase)
+{
+	QString devpath;
+	if (m_dc->device().is_initialized())
+		devpath = QString::fromStdString(m_dc->device().get());
+
+	// Parse the Emulator Arguments
+	m_speed = 1.0;
+	if (m_dc->driver_args().is_initialized())
+	{
+		QStringList args = QString::fromStdString(m_dc->driver_args().get()).split(':', QString::SkipEmptyParts);
+		for (int i = 0; i < args.size(); ++i)
+		{
+			bool ok;
+			double speed = args[i].section('=', 1).toDouble(& ok);
+			if ((args[i].section('=', 0, 0) == "speed") && ok && (speed >= 0))
+				m_speed = speed;
+		}
+	}
+
+	// Load or Generate the Capture
+	try
+	{
+		if (devpath.startsWith(EMULATOR_SYNTHETIC))
+			m_replay.synthetic(devpath.mid(strlen(EMULATOR_SYNTHETIC)).toUInt(), QString::fromStdString(m_dc->serial()).toUInt());
+		else
+			m_replay.load(devpath);
+	}
+	catch (std::exception & e)
+	{
+		emit transferError(QString("Failed to load the capture for '%1': %2")
+			.arg(dcname)
+			.arg(QString::fromStdString(e.what())));
+		return false;
 	}
 
+	m_stats.loadMs = phase.restart();
+	m_stats.connectMs = 0;
+
+	emit status(QString("Loaded capture of %1 dives from '%2'").arg(m_replay.dives().size()).arg(devpath));
 	emit status(QString("Connected to '%1'").arg(dcname));
+	return true;
+}
+
+void TransferWorker::parse_task(unsigned long seq, const dive_buffer_t & buffer)
+{
+	if (cancelled())
+		return;
+
+	// Key the Dive from the uncompressed Buffer, outside the Order Lock
+	QByteArray key = DiveIndex::key(buffer);
+	bool existing = m_index.contains(key);
+
+	parser_data data;
+	data.mixtable = m_mixes.get();
+	data.record = m_capturePath.isEmpty() ? 0 : & m_capture.dives()[seq].tokens;
+
+	// Dives already in the Logbook are only parsed to record their Tokens
+	if (existing && ! data.record)
+	{
+		emit_ordered(seq, Profile::Ptr(), key);
+		return;
+	}
+
+	reset_parser(data, m_air);
+
+	capture_parse_fn header = data.record ? & record_header : & parse_header;
+	capture_parse_fn profile = data.record ? & record_profile : & parse_profile;
+
+	// Parse the Header and Profile
+	if (m_emulated)
+		m_replay.replay(m_replayBase + seq, header, profile, & data);
+	else
+		m_driver->parse(buffer, header, profile, & data);
+
+	emit_ordered(seq, existing ? Profile::Ptr() : build_profile(m_dc, buffer, data), key);
+}
+
+void TransferWorker::run()
+{
+	dive_data_t dive_data;
+	QString dcname;
+	if (m_dc->name().is_initialized())
+		dcname = QString::fromStdString(m_dc->name().get());
+	else
+		dcname = QString("'%1' Device").arg(QString::fromStdString(m_dc->driver()));
+
+	// The Logbook is only read on the GUI Thread, by prepare()
+	if (! m_mixes)
+	{
+		emit transferError(QString("Transfer from %1 was not prepared").arg(dcname));
+		return;
+	}
+
+	emit status(QString("Starting Transfer from %1").arg(dcname));
+
+	QElapsedTimer phase;
+	phase.start();
+
+	// Load the Driver and Connect to the Device
+	if (! (m_emulated ? open_emulator(dcname, phase) : open_device(dcname, phase)))
+		return;
+
+	// Setup the Parse Pool (the Driver is only called from one Thread)
+	QThreadPool parsePool;
+	parsePool.setMaxThreadCount(m_emulated ? m_parseThreads : 1);
+
+	m_parsePool = & parsePool;
+	m_batchTimer.start();
 
 	// Transfer Data
+	phase.restart();
 	try
 	{
-		dive_data = dev->transfer(& device_info, & transfer_callback_fn, this);
+		if (m_emulated)
+			dive_data = emulate_transfer();
+		else
+			dive_data = m_driver->transfer(& device_info, & transfer_callback_fn, this);
 	}
 	catch (std::exception & e)
 	{
+		parsePool.waitForDone();
+		m_parsePool = 0;
+
 		emit transferError(QString::fromStdString(e.what()));
 		return;
 	}
 
+	m_stats.transferMs = phase.restart();
+
 	// No guarantee that transfer_callback_fn is called
 	if (! m_started)
 	{
@@ -596,15 +1002,79 @@ void TransferWorker::run()
 
 	if (dive_data.size())
 	{
-		// Store new Token
-		if (m_updateToken)
-			m_dc->setToken(dive_data.back().second);
+		// Copy the Dives to the Capture before the Buffers are handed off
+		dive_data_t::iterator it;
+		if (! m_capturePath.isEmpty())
+		{
+			m_capture.dives().resize(dive_data.size());
 
-		// Parse Data
+			std::vector<capture_dive_t>::iterator cit = m_capture.dives().begin();
+			for (it = dive_data.begin(); it != dive_data.end(); it++, cit++)
+			{
+				cit->data = it->first;
+				cit->token = it->second;
+			}
+		}
+
+		// Hand the Dives to the Parse Pool
 		emit status(QString("Parsing %1 dives").arg(dive_data.size()));
-		parse_dives(dev, dive_data);
+
+		for (it = dive_data.begin(); it != dive_data.end(); it++)
+			enqueue(* it);
 	}
 
+	parsePool.waitForDone();
+	m_parsePool = 0;
+
+	// Send the final Batch
+	{
+		QMutexLocker lock(& m_orderLock);
+		flush_batch();
+		m_stats.dives = m_parsed;
+		m_stats.duplicates = m_duplicates;
+	}
+
+	/*
+	 * Parse Tasks skip their Dives once the Transfer is cancelled, so the
+	 * delivered Dives may be incomplete.  Fail the Transfer rather than let
+	 * the caller import a partial set, and leave the Token where it was so
+	 * the skipped Dives are transferred again next time.
+	 */
+	if (cancelled())
+	{
+		emit transferError(QString("Transfer cancelled"));
+		return;
+	}
+
+	if (m_duplicates)
+		emit status(QString("Skipped %1 dives already in the logbook").arg(m_duplicates));
+
+	m_stats.parseMs = phase.elapsed();
+
+	// Report the new Token for the Caller to store
+	if (m_updateToken && dive_data.size())
+		m_stats.token = dive_data.back().second;
+
+	if (! m_capturePath.isEmpty())
+		save_capture();
+
+	emit stats(m_stats);
+
 	emit status(QString("Transfer Successful"));
 	emit finished();
 }
+
+void TransferWorker::save_capture()
+{
+	m_capture.setTransferMs(m_stats.transferMs);
+
+	try
+	{
+		m_capture.save(m_capturePath);
+		emit status(QString("Saved transfer capture to '%1'").arg(m_capturePath));
+	}
+	catch (std::exception & e)
+	{
+		emit status(QString("Failed to save transfer capture: %1").arg(QString::fromStdString(e.what())));
+	}
+}
@@ -31,10 +31,16 @@
 
 #include <cstdint>
 #include <list>
+#include <map>
+#include <string>
 #include <vector>
 
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QMutex>
 #include <QObject>
 #include <QRunnable>
+#include <QThreadPool>
 
 /*
  * FIX for broken Qt4 moc and BOOST_JOIN error
@@ -46,9 +52,14 @@
 #include <benthos/divecomputer/driver.hpp>
 
 #include <benthos/logbook/dive_computer.hpp>
+#include <benthos/logbook/mix.hpp>
 #include <benthos/logbook/profile.hpp>
 #include <benthos/logbook/session.hpp>
 
+#include "util/devicecapture.hpp"
+#include "util/diveindex.hpp"
+#include "util/mixtable.hpp"
+
 using namespace benthos::dc;
 using namespace benthos::logbook;
 
@@ -56,6 +67,44 @@ typedef std::vector<uint8_t>					dive_buffer_t;
 typedef std::pair<dive_buffer_t, std::string>	dive_entry_t;
 typedef std::list<dive_entry_t>					dive_data_t;
 
+//! Batch of Parsed Profiles
+typedef std::vector<Profile::Ptr>				profile_list_t;
+
+//! Parsed Profile with its Duplicate Index Key, held for Re-ordering
+typedef std::pair<Profile::Ptr, QByteArray>		reorder_entry_t;
+
+/**
+ * @brief Transfer Phase Timing
+ *
+ * Wall-clock time spent in each phase of a transfer, in milliseconds, along
+ * with the amount of data moved.  The parse phase runs from the end of the
+ * data transfer until the last dive has been parsed.  The persist phase is
+ * filled in by the caller once the dives have been saved.
+ *
+ * The token is that of the last dive transferred, which the caller stores in
+ * the dive computer on the GUI thread.  It is empty when the token should not
+ * be updated.
+ */
+typedef struct
+{
+	qint64			loadMs;
+	qint64			connectMs;
+	qint64			transferMs;
+	qint64			parseMs;
+	qint64			persistMs;
+	unsigned long	bytes;
+	unsigned long	dives;
+	unsigned long	duplicates;
+	std::string		token;
+} transfer_stats_t;
+
+/**
+ * @brief Write a Transfer Summary Record to the Log
+ * @param[in] Dive Computer
+ * @param[in] Transfer Statistics, including the persist time
+ */
+void logTransferStats(DiveComputer::Ptr dc, const transfer_stats_t & stats);
+
 /**
  * @brief Dive Computer Transfer Worker
  *
@@ -72,19 +121,75 @@ typedef std::list<dive_entry_t>					dive_data_t;
  * a flag in the constructor.
  *
  * Once the connection has been opened and the computer verified, data is
- * transferred, starting at the token stored in the instance.  The token is then
- * updated and the connection closed.  Updating the token can be skipped with a
- * flag in the constructor.  The transferred data is then parsed and sent to the
- * calling application.  The Transfer Worker does not directly add dives to the
- * logbook; rather, the parsed profiles are passed back to the caller through
- * the parsedDive() slot.  This enables the calling procedure to do further
- * processing and possibly ignore the dive.
- *
- * @note Profile::Ptr must be registered with the Qt metadata system in order
- * for the signal/slot to work correctly with TransferWorker.  To register, add
- * the following line to the application initialization:
+ * transferred, starting at the token stored in the instance.  Once all dives
+ * have been parsed, the new token is reported in the transfer statistics so
+ * the caller can store it on the GUI thread; the worker never modifies the
+ * dive computer.  Reporting the token can be skipped with a flag in the
+ * constructor.
+ *
+ * Dives are parsed on a thread pool once the data transfer has returned; the
+ * driver hands over all dive buffers together, so parsing does not overlap
+ * with the transfer.  Buffers are independent, so each parse task has its own
+ * parser state and tasks run in parallel; the results are re-ordered so that
+ * dives are delivered in the order the device returned them.  A running count
+ * of parsed dives is reported through the parsed() signal.  The worker waits
+ * for the pool to finish before emitting finished().  If the transfer is
+ * cancelled while dives are being parsed, transferError() is emitted instead
+ * and no token is reported.
+ *
+ * The driver API makes no promise that one Driver instance may parse from
+ * several threads at once, and a second instance can only be had by opening
+ * the device again, so dives from a real device are parsed on a single pool
+ * thread.  Only the emulated device, which replays its captured parser tokens
+ * without a Driver, parses on several threads.
+ *
+ * To avoid flooding the receiver's event queue during large transfers, parsed
+ * dives are delivered in batches through parsedDives(), and progress() is
+ * rate-limited.  A batch is sent when it is full or has been held for a
+ * fixed interval, and any remaining dives are sent before finished().
+ *
+ * Dives which are already in the logbook are dropped before delivery.  The
+ * worker builds a DiveIndex of the computer's existing profiles in prepare(),
+ * and each parse task keys its device buffer and checks it against the index
+ * before parsing, so known dives are not parsed at all unless the transfer is
+ * being recorded.  Dives repeated within the transfer are dropped in device
+ * order under the re-ordering lock, where only a set lookup runs, so
+ * importing the same dives again is idempotent.
+ *
+ * The logbook's gas mixes are held in a MixTable which is loaded before the
+ * transfer starts, and mixes first seen during the transfer are added to it,
+ * so the parse tasks never query the database and dives which use the same
+ * new gas share a single Mix instance.
+ *
+ * The parsed dives are sent to the calling application.  The Transfer Worker
+ * does not directly add dives to the logbook; rather, the parsed profiles are
+ * passed back to the caller through the parsedDives() signal.  This enables
+ * the calling procedure to do further processing and possibly ignore the
+ * dive.
+ *
+ * The time spent loading the driver, connecting, transferring and parsing is
+ * measured and reported through the stats() signal just before finished().
+ *
+ * The logbook session is not thread-safe, so the worker only reads it in
+ * prepare(), which the caller must call on the GUI thread before starting
+ * the worker.  Several workers may run at once, one per dive computer; they
+ * should share one MixTable and divide the parse threads between them (see
+ * setParseThreads()).
+ *
+ * A transfer can be recorded to a DeviceCapture file with setCaptureFile().
+ * Dive computers with the EMULATOR_DRIVER driver replay such a capture, named
+ * by the device path, through the same signals as a real transfer; a device
+ * path of the form "synthetic:<count>" replays generated dives instead.  The
+ * "speed" driver argument scales the replay rate relative to the captured
+ * transfer time, and a speed of 0 replays the data as fast as possible.
+ *
+ * @note profile_list_t and transfer_stats_t must be registered with the Qt
+ * metadata system in order for the signal/slot to work correctly with
+ * TransferWorker.  To register, add the following lines to the application
+ * initialization:
  * @code
- * qRegisterMetaType<Profile::Ptr>();
+ * qRegisterMetaType<profile_list_t>("profile_list_t");
+ * qRegisterMetaType<transfer_stats_t>("transfer_stats_t");
  * @endcode
  */
 class TransferWorker: public QObject, public QRunnable
@@ -98,7 +203,7 @@ public:
 	 * @param[in] Dive Computer instance from which to transfer dives
 	 * @param[in] Session instance where the dives will be persisted
 	 * @param[in] Flag whether to verify the dive computer serial number
-	 * @param[in] Flag whether to update the dive computer token
+	 * @param[in] Flag whether to report a new dive computer token
 	 * @param[in] Parent object
 	 */
 	TransferWorker(DiveComputer::Ptr dc, Session::Ptr session, bool checkSerNo = true, bool updateToken = true, QObject * parent = 0);
@@ -114,6 +219,36 @@ public:
 	//! @return If the Transfer has been Cancelled
 	bool cancelled() const;
 
+	/**
+	 * @brief Read the Logbook before the Transfer
+	 * @param[in] Gas Mix Table to share with other Workers (loads its own
+	 * table from the logbook if empty)
+	 *
+	 * Builds the duplicate dive index and sets the mix table.  The logbook
+	 * session is not thread-safe, so this must be called from the GUI thread
+	 * before the worker is started; run() fails the transfer otherwise.
+	 */
+	void prepare(MixTable::Ptr mixes = MixTable::Ptr());
+
+	/**
+	 * @brief Record the Transfer to a Capture File
+	 * @param[in] Capture File Path (an empty path disables recording)
+	 *
+	 * The capture is written after all dives have been parsed.  Failing to
+	 * write it is reported through status() and does not fail the transfer.
+	 */
+	void setCaptureFile(const QString & path);
+
+	/**
+	 * @brief Set the Number of Parse Threads
+	 * @param[in] Maximum Number of Dives parsed at once (at least 1)
+	 *
+	 * Defaults to QThread::idealThreadCount().  Callers running several
+	 * workers at once should divide the threads between them.  Transfers
+	 * from a real device always parse on one thread (see the class notes).
+	 */
+	void setParseThreads(int count);
+
 public slots:
 
 	/**
@@ -135,19 +270,29 @@ signals:
 	void finished();
 
 	/**
-	 * @brief Parsed Dive Signal
-	 * @param[out] Parsed Profile
+	 * @brief Parsed Dives Signal
+	 * @param[out] Batch of Parsed Profiles, in Device Order
 	 *
-	 * Emitted when a dive has been parsed.  The profile contains the waypoint
-	 * data and the associated Dive instance holds dive header information.  Any
-	 * mixes that were not found in the logbook are also attached to the Profile
-	 * instance object.
+	 * Emitted with each batch of parsed dives which are not already in the
+	 * logbook.  Each profile contains the waypoint data and the associated
+	 * Dive instance holds dive header information.  Any mixes that were not
+	 * found in the logbook are also attached to the Profile instance object.
 	 *
 	 * It is the responsibility of the slot to call Session::add() on the
 	 * profile and linked objects (if required by the merge policy). prior to
 	 * committing the transaction.
 	 */
-	void parsedDive(Profile::Ptr);
+	void parsedDives(const profile_list_t &);
+
+	/**
+	 * @brief Parsed Dive Count Signal
+	 * @param[out] Number of Dives Parsed so far
+	 *
+	 * Emitted along with each parsedDives() batch, so that the caller can
+	 * show parsing progress alongside the data transfer progress.  The count
+	 * includes dives which were dropped as duplicates.
+	 */
+	void parsed(unsigned long);
 
 	/**
 	 * @brief Data Transfer Progress Signal
@@ -158,6 +303,14 @@ signals:
 	 */
 	void progress(unsigned long);
 
+	/**
+	 * @brief Transfer Statistics Signal
+	 * @param[out] Phase Timing for the Transfer
+	 *
+	 * Emitted once after a successful transfer, directly before finished().
+	 */
+	void stats(const transfer_stats_t &);
+
 	/**
 	 * @brief Data Transfer Status Signal
 	 * @param[out] Status Message
@@ -194,10 +347,44 @@ public:
 	//! @internal Do not call from client code
 	int driver_devinfo(uint8_t model, uint32_t serial, uint32_t ticks, std::string &);
 
+	//! @internal Do not call from client code
+	void parse_task(unsigned long seq, const dive_buffer_t & buffer);
+
 protected:
 
-	//! Parse Dive Data
-	void parse_dives(Driver::Ptr driver, const dive_data_t & dives);
+	//! Load the Driver and Connect to the Device
+	bool open_device(const QString & dcname, QElapsedTimer & phase);
+
+	//! Load the Capture replayed by the Emulated Device
+	bool open_emulator(const QString & dcname, QElapsedTimer & phase);
+
+	/**
+	 * @brief Replay the Data Transfer from the Emulator Capture
+	 * @return Dives after the Transfer Token, in Device Order
+	 *
+	 * Calls the device info and progress callbacks as a driver would, paced
+	 * by the captured transfer time and the emulator speed.
+	 */
+	dive_data_t emulate_transfer();
+
+	//! Write the recorded Capture File
+	void save_capture();
+
+	//! Queue a Dive Buffer to the Parse Pool (the buffer is swapped out of dive)
+	void enqueue(dive_entry_t & dive);
+
+	/**
+	 * @brief Emit a Parsed Dive in Device Order
+	 * @param[in] Sequence Number of the Dive
+	 * @param[in] Parsed Profile (empty if the Dive is already in the Logbook)
+	 * @param[in] Duplicate Index Key of the Profile
+	 *
+	 * Holds the profile until all dives before it have been emitted.
+	 */
+	void emit_ordered(unsigned long seq, Profile::Ptr profile, const QByteArray & key);
+
+	//! Send the Pending Batch of Parsed Dives (m_orderLock must be held)
+	void flush_batch();
 
 private:
 	DiveComputer::Ptr			m_dc;
@@ -208,6 +395,32 @@ private:
 	bool						m_cancel;
 	bool						m_started;
 
+	QThreadPool *				m_parsePool;
+	int							m_parseThreads;
+	Driver::Ptr					m_driver;
+	Mix::Ptr					m_air;
+	MixTable::Ptr				m_mixes;
+
+	QMutex							m_orderLock;
+	std::map<unsigned long, reorder_entry_t>	m_reorder;
+	profile_list_t					m_batch;
+	QElapsedTimer					m_batchTimer;
+	DiveIndex						m_index;
+	unsigned long					m_queued;
+	unsigned long					m_parsed;
+	unsigned long					m_duplicates;
+
+	QElapsedTimer				m_progressTimer;
+	transfer_stats_t			m_stats;
+
+	QString						m_capturePath;
+	DeviceCapture				m_capture;
+
+	bool						m_emulated;
+	double						m_speed;
+	DeviceCapture				m_replay;
+	size_t						m_replayBase;
+
 };
 
 #endif /* TRANSFERWORKER_HPP_ */